@@ -9,18 +9,67 @@
 #ifndef MP_ALLOC_H
 #define MP_ALLOC_H  1
 
-#include <stdlib.h>
+#include <stddef.h>
 
 #include <mp/types.h>
 
-static inline digit_t *mp_alloc (size_t len)
-{
-	return malloc (sizeof (digit_t) * len);
-}
+/*
+ * Allocator interface: allocation, reallocation and release hooks with
+ * opaque context passed to each of them. The realloc hook must accept
+ * NULL pointer, the free hook must accept NULL pointer as well.
+ *
+ * Function mp_set_allocator registers allocator o for the calling thread
+ * and returns previously registered one. If o is NULL then the standard
+ * malloc, realloc and free functions are used (the default). Note that
+ * a memory block must be released with the same allocator it was
+ * allocated with.
+ */
+struct mp_allocator {
+	void *(*alloc)   (void *ctx, size_t size);
+	void *(*realloc) (void *ctx, void *p, size_t size);
+	void  (*free)    (void *ctx, void *p);
+	void *ctx;
+};
+
+const struct mp_allocator *mp_set_allocator (const struct mp_allocator *o);
+
+/*
+ * Function mp_alloc allocates space for len digits with current allocator
+ * and returns pointer to it, or NULL on failure.
+ *
+ * Function mp_realloc changes the size of memory block o to len digits,
+ * and returns pointer to it, or NULL on failure (the block o is left
+ * untouched in this case).
+ *
+ * Function mp_free releases memory block o.
+ */
+digit_t *mp_alloc   (size_t len);
+digit_t *mp_realloc (digit_t *o, size_t len);
+void     mp_free    (digit_t *o);
+
+/*
+ * Bump arena allocator with size-class pools. Blocks are carved from big
+ * chunks, released blocks are kept in per-class free lists for reuse,
+ * and all the memory is returned to the system at once by mp_arena_fini.
+ * An arena is not thread-safe: use one arena per thread.
+ *
+ * Function mp_arena_init initializes arena o and its allocator hooks,
+ * which may be registered with mp_set_allocator (&o->allocator).
+ *
+ * Function mp_arena_fini releases all memory of arena o. Unregister the
+ * arena before calling this function.
+ */
+#define MP_ARENA_CLASSES  24
+
+struct mp_arena {
+	struct mp_allocator allocator;
+	struct mp_arena_chunk *chunk;		/* list of chunks	*/
+	char *next;				/* bump pointer		*/
+	size_t avail;				/* bump space left	*/
+	void *pool[MP_ARENA_CLASSES];		/* free lists		*/
+};
 
-static inline void mp_free (digit_t *o)
-{
-	free (o);
-}
+void mp_arena_init (struct mp_arena *o);
+void mp_arena_fini (struct mp_arena *o);
 
 #endif  /* MP_ALLOC_H */
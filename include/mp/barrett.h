@@ -0,0 +1,44 @@
+/*
+ * MP Core Modular Arithmetics: Barrett Reduction
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef MP_BARRETT_H
+#define MP_BARRETT_H  1
+
+#include <mp/types.h>
+
+/*
+ * Barrett context: normalized modulus D = M * 2^shift of len digits,
+ * reciprocal V = floor (B^(2 len) / D) of len + 1 digits and scratch area,
+ * all in one memory block. Unlike Montgomery multiplication it works for
+ * any modulus, even ones included. Note that the context is not
+ * thread-safe due to shared scratch area.
+ *
+ * Function mp_barrett_init initializes context o for modulus (m, len),
+ * computes the reciprocal by Newton iteration, and returns non-zero on
+ * success, or zero if memory allocation failed. Constraint: the most
+ * significant digit of M is not zero.
+ *
+ * Function mp_barrett_fini releases resources of context o.
+ *
+ * Function mp_barrett_reduce computes X mod M, where X = (x, 2 len), and
+ * stores result into (r, len). Constraint: X < M * B^len, e.g. X is a
+ * product of two residues modulo M.
+ */
+struct mp_barrett {
+	digit_t *d, *v, *ws;
+	size_t len;
+	int shift;
+};
+
+int  mp_barrett_init (struct mp_barrett *o, const digit_t *m, size_t len);
+void mp_barrett_fini (struct mp_barrett *o);
+
+void mp_barrett_reduce (const struct mp_barrett *o, digit_t *r,
+			const digit_t *x);
+
+#endif  /* MP_BARRETT_H */
@@ -91,4 +91,52 @@ MP_BITWISE_TWO (diff, x & ~y)
  */
 MP_BITWISE_TWO (xor, x ^ y)
 
+/*
+ * The function mp_bit returns bit i of set of bits y.
+ */
+static inline int mp_bit (const digit_t *y, size_t i)
+{
+	return (y[i / MP_DIGIT_BITS] >> (i % MP_DIGIT_BITS)) & 1;
+}
+
+/*
+ * The function mp_bits returns n < MP_DIGIT_BITS bits of set of bits
+ * (y, len) starting from bit i. Bits past the end of set are zero. The
+ * memory access pattern depends on positions only, not on bit values.
+ */
+static inline
+digit_t mp_bits (const digit_t *y, size_t len, size_t i, size_t n)
+{
+	const size_t k = i / MP_DIGIT_BITS, s = i % MP_DIGIT_BITS;
+	digit_t v = y[k] >> s;
+
+	if (s + n > MP_DIGIT_BITS && k + 1 < len)
+		v |= y[k + 1] << (MP_DIGIT_BITS - s);
+
+	return v & (((digit_t) 1 << n) - 1);
+}
+
+/*
+ * The function mp_select copies entry e of table (T, n * len) into
+ * (r, len). The whole table is scanned and masked, thus the memory access
+ * pattern does not depend on e.
+ */
+static inline void mp_select (digit_t *r, const digit_t *T, size_t n,
+			      size_t len, digit_t e)
+{
+	digit_t d, mask;
+	size_t i, j;
+
+	for (j = 0; j < len; ++j)
+		r[j] = 0;
+
+	for (i = 0; i < n; ++i, T += len) {
+		d = e ^ i;
+		mask = ((d | (0 - d)) >> (MP_DIGIT_BITS - 1)) - 1;
+
+		for (j = 0; j < len; ++j)
+			r[j] |= T[j] & mask;
+	}
+}
+
 #endif  /* MP_BIT_H */
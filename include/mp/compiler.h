@@ -25,4 +25,8 @@
 #include <mp/compiler/gcc.h>
 #endif
 
+#ifndef MP_UNROLL
+#define MP_UNROLL(n)
+#endif
+
 #endif  /* MP_COMPILER_H */
@@ -96,4 +96,13 @@
 #endif
 #endif  /* ctz */
 
+#if !defined (MP_UNROLL) && (__GNUC__ >= 8 || defined (__clang__))
+#define MP_PRAGMA(x)	_Pragma (#x)
+#define MP_UNROLL(n)	MP_PRAGMA (GCC unroll n)
+#endif  /* unroll */
+
+#ifndef MP_THREAD_LOCAL
+#define MP_THREAD_LOCAL	__thread
+#endif
+
 #endif  /* MP_COMPILER_GCC_H */
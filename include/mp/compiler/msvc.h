@@ -95,4 +95,8 @@ static inline int mp_msvc_ctz (digit_t x)
 #define mp_digit_ctz	mp_msvc_ctz
 #endif  /* ctz */
 
+#ifndef MP_THREAD_LOCAL
+#define MP_THREAD_LOCAL	__declspec (thread)
+#endif
+
 #endif  /* MP_COMPILER_MSVC_H */
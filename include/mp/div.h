@@ -11,6 +11,14 @@
 
 #include <mp/types.h>
 
+/*
+ * Divisor length starting from which mp_div and mp_mod use recursive
+ * (Burnikel-Ziegler) division.
+ */
+#ifndef MP_DIV_DC_CUTOFF
+#define MP_DIV_DC_CUTOFF  60
+#endif
+
 /*
  * Function mp_div_1 divides (x, len) by y, stores result into (r, len),
  * and returns the remainder value.
@@ -33,10 +41,69 @@
 digit_t mp_div_1 (digit_t *r, const digit_t *x, size_t len, digit_t y);
 digit_t mp_mod_1 (const digit_t *x, size_t len, digit_t y);
 
+/*
+ * Function mp_div_1_inv precomputes the inverse of divisor y for functions
+ * mp_div_1_pi and mp_mod_1_pi. Constraint: y is not zero.
+ *
+ * Functions mp_div_1_pi and mp_mod_1_pi do the same things as functions
+ * mp_div_1 and mp_mod_1, but take the inverse v of divisor y precomputed
+ * with mp_div_1_inv, and divide with multiplications only.
+ */
+digit_t mp_div_1_inv (digit_t y);
+digit_t mp_div_1_pi  (digit_t *r, const digit_t *x, size_t len, digit_t y,
+		      digit_t v);
+digit_t mp_mod_1_pi  (const digit_t *x, size_t len, digit_t y, digit_t v);
+
+/*
+ * Function mp_mod_1s_init precomputes constants for divisor y into (c,
+ * MP_MOD_1S_SIZE): the inverse, the normalization shift, and B^i mod y
+ * for i = 1, 2, 3.
+ *
+ * Function mp_mod_1s does the same thing as function mp_mod_1, but takes
+ * the constants c precomputed with mp_mod_1s_init, and folds two digits
+ * per step with independent multiplications. Constraint: 0 < y <= B / 4.
+ *
+ * Function mp_mod_1s_batch computes remainders of (x, len) for the table
+ * of count divisors (y, count) with their constants (c, count *
+ * MP_MOD_1S_SIZE), and stores them into (r, count). Useful for trial
+ * division by small primes. Constraints are the same as for mp_mod_1s.
+ */
+#define MP_MOD_1S_SIZE  5
+
+void    mp_mod_1s_init  (digit_t *c, digit_t y);
+digit_t mp_mod_1s       (const digit_t *x, size_t len, digit_t y,
+			 const digit_t *c);
+void    mp_mod_1s_batch (digit_t *r, const digit_t *x, size_t len,
+			 const digit_t *y, const digit_t *c, size_t count);
+
 size_t mp_div (digit_t *q, digit_t *r, const digit_t *n, size_t nlen,
 				       const digit_t *d, size_t dlen);
 
 size_t mp_mod (digit_t *r, const digit_t *n, size_t nlen,
 			   const digit_t *d, size_t dlen);
 
+/*
+ * Function mp_divexact_by3 divides (x, len) by 3, stores result into
+ * (r, len), and returns zero if division is exact. Used for Toom-Cook
+ * interpolation, where the division is known to be exact.
+ */
+digit_t mp_divexact_by3 (digit_t *r, const digit_t *x, size_t len);
+
+/*
+ * Function mp_divexact_1 divides (x, len) by y, stores result into (r,
+ * len), and returns zero if division is exact. Multiplies by the inverse
+ * of y modulo B instead of dividing. Constraint: y is not zero.
+ *
+ * Function mp_divexact divides (x, xlen) by (y, ylen), and stores
+ * quotinent into (q, xlen - ylen + 1). The result is undefined if the
+ * division is not exact. Constraints: the least significant digit of y
+ * is odd, xlen >= ylen > 0, and q does not overlap x.
+ *
+ * Tip: Shift x and y right by ctz(y) before calling the mp_divexact
+ * function.
+ */
+digit_t mp_divexact_1 (digit_t *r, const digit_t *x, size_t len, digit_t y);
+void    mp_divexact   (digit_t *q, const digit_t *x, size_t xlen,
+				   const digit_t *y, size_t ylen);
+
 #endif  /* MP_DIV_H */
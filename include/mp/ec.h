@@ -0,0 +1,93 @@
+/*
+ * MP Core Elliptic Curve Point Arithmetic
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef MP_EC_H
+#define MP_EC_H  1
+
+#include <mp/mont-mul.h>
+
+/*
+ * Short Weierstrass curve y^2 = x^3 + a x + b over prime field GF(p):
+ * Montgomery context for p, coefficients a, b and b3 = 3 b in Montgomery
+ * representation, temporaries for point formulas and scratch area for
+ * scalar multiplication. Computed once per curve and then reused. Note
+ * that the curve is not thread-safe due to shared scratch areas.
+ *
+ * Points are stored in homogeneous projective coordinates (X : Y : Z) in
+ * Montgomery representation as 3 len digits, affine point is (X / Z, Y /
+ * Z), and the point at infinity is (0 : 1 : 0). Point formulas are the
+ * complete ones of Renes, Costello and Batina, "Complete addition formulas
+ * for prime order elliptic curves": they have no exceptional cases, thus
+ * neither branches nor checks for doubling or infinity are required.
+ *
+ * Function mp_ec_init initializes curve o for prime (p, len) and
+ * coefficients (a, len), (b, len), and returns non-zero on success, or
+ * zero if memory allocation failed. Constraints: p is odd prime, the most
+ * significant digit of p is not zero, A < p, B < p.
+ *
+ * Function mp_ec_fini releases resources of curve o.
+ *
+ * Function mp_ec_zero stores the point at infinity into R.
+ *
+ * Function mp_ec_push converts affine point (x, len), (y, len) to the
+ * projective form R. Function mp_ec_pull converts point P back to affine
+ * form, and returns non-zero on success, or zero if P is the point at
+ * infinity. The conversion costs one constant-time inversion.
+ *
+ * Function mp_ec_check returns non-zero if affine point (x, len), (y,
+ * len) lies on the curve, or zero otherwise.
+ *
+ * Functions mp_ec_neg, mp_ec_add and mp_ec_dbl compute R = -P, R = P + Q
+ * and R = 2 P, respectively. R may overlap P or Q. Modular additions and
+ * subtractions are corrected by masked modulus and Montgomery products
+ * use masked final subtraction, thus the sequence of operations does not
+ * depend on coordinates.
+ *
+ * Function mp_ec_mul_sec computes R = K P with fixed 4-bit window and
+ * full masked scan of the table of 16 multiples of P for every window,
+ * thus the sequence of operations and memory accesses does not depend on
+ * scalar (k, len). Use it for secret scalars. Only n + 1 low bits of
+ * scalar are scanned, where n is the bit length of p: by Hasse bound the
+ * group order is below 2^(n + 1), thus it is enough for scalars reduced
+ * modulo the order. Constraint: K < 2^(n + 1).
+ *
+ * Function mp_ec_mul2 computes R = U P + V Q with interleaved width-5
+ * non-adjacent forms of scalars (u, len) and (v, len), and returns
+ * non-zero on success, or zero if memory allocation failed. The timing
+ * depends on scalars, thus use it for public ones only, as in signature
+ * verification.
+ */
+struct mp_ec {
+	struct mp_mont_ctx p;
+	digit_t *a, *b, *b3, *t, *ws;
+	size_t len, bits;
+};
+
+int  mp_ec_init  (struct mp_ec *o, const digit_t *p, size_t len,
+		  const digit_t *a, const digit_t *b);
+void mp_ec_fini  (struct mp_ec *o);
+
+void mp_ec_zero  (const struct mp_ec *o, digit_t *r);
+void mp_ec_push  (const struct mp_ec *o, digit_t *r, const digit_t *x,
+		  const digit_t *y);
+int  mp_ec_pull  (const struct mp_ec *o, digit_t *x, digit_t *y,
+		  const digit_t *p);
+int  mp_ec_check (const struct mp_ec *o, const digit_t *x, const digit_t *y);
+
+void mp_ec_neg   (const struct mp_ec *o, digit_t *r, const digit_t *p);
+void mp_ec_add   (const struct mp_ec *o, digit_t *r, const digit_t *p,
+		  const digit_t *q);
+void mp_ec_dbl   (const struct mp_ec *o, digit_t *r, const digit_t *p);
+
+void mp_ec_mul_sec (const struct mp_ec *o, digit_t *r, const digit_t *p,
+		    const digit_t *k);
+int  mp_ec_mul2    (const struct mp_ec *o, digit_t *r,
+		    const digit_t *u, const digit_t *p,
+		    const digit_t *v, const digit_t *q);
+
+#endif  /* MP_EC_H */
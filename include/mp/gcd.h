@@ -0,0 +1,54 @@
+/*
+ * MP Core Greatest Common Divisor
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef MP_GCD_H
+#define MP_GCD_H  1
+
+#include <mp/types.h>
+
+/*
+ * Operand length starting from which mp_gcd uses Lehmer algorithm instead
+ * of binary one.
+ */
+#ifndef MP_GCD_LEHMER_CUTOFF
+#define MP_GCD_LEHMER_CUTOFF  3
+#endif
+
+/*
+ * Operand length starting from which half-GCD algorithm recurses instead
+ * of doing Lehmer steps.
+ */
+#ifndef MP_GCD_HGCD_CUTOFF
+#define MP_GCD_HGCD_CUTOFF  30
+#endif
+
+/*
+ * Operand length starting from which mp_gcd and mp_gcdext use half-GCD
+ * algorithm instead of Lehmer one.
+ */
+#ifndef MP_GCD_DC_CUTOFF
+#define MP_GCD_DC_CUTOFF  4000
+#endif
+
+/*
+ * Function mp_gcd computes the greatest common divisor G of (x, xlen) and
+ * (y, ylen), stores it into (g, max (xlen, ylen)), and returns the size
+ * of G. Operands need not be normalized. Returns zero if both operands
+ * are zero or on memory allocation failure.
+ *
+ * Function mp_gcdext computes G as mp_gcd does, and the cofactor S, such
+ * that G = S X - T Y for some T, 0 < S <= Y / G and 0 <= T < X / G, and
+ * stores S into (s, ylen). Constraints: X and Y are not zero. Thus, for
+ * G = 1, S is the inverse of X modulo Y, and T = (S X - 1) / Y.
+ */
+size_t mp_gcd    (digit_t *g, const digit_t *x, size_t xlen,
+			      const digit_t *y, size_t ylen);
+size_t mp_gcdext (digit_t *g, digit_t *s, const digit_t *x, size_t xlen,
+					  const digit_t *y, size_t ylen);
+
+#endif  /* MP_GCD_H */
@@ -10,6 +10,7 @@
 #define MP_MOD_H  1
 
 #include <mp/add.h>
+#include <mp/digit.h>
 
 /*
  * Function mp_mod_add_n adds Y = (y, len) to X = (x, len) modulo M =
@@ -34,4 +35,55 @@ void mp_mod_sub_n (digit_t * r, const digit_t *x, const digit_t *y,
 		mp_add_n (r, r, m, len, 0);
 }
 
+/*
+ * Function mp_mod_norm_n_sec stores T - M into R = (r, len) if the top
+ * carry c is set or T = (t, len) >= M, and T otherwise. It scans M twice:
+ * first to get the borrow of T - M, then to subtract M masked by it, thus
+ * the sequence of operations does not depend on T. R may be equal to T.
+ * Constraint: T < 2M.
+ */
+static inline
+void mp_mod_norm_n_sec (digit_t *r, const digit_t *t, const digit_t *m,
+			size_t len, char c)
+{
+	digit_t s, mask;
+	char b = 0;
+	size_t j;
+
+	for (j = 0; j < len; ++j)
+		b = mp_digit_sbb (&s, t[j], m[j], b);
+
+	mask = 0 - (digit_t) ((c | (b ^ 1)) & 1);
+
+	for (j = 0, b = 0; j < len; ++j)
+		b = mp_digit_sbb (&r[j], t[j], m[j] & mask, b);
+}
+
+/*
+ * Functions mp_mod_add_n_sec and mp_mod_sub_n_sec do the same thing as
+ * functions mp_mod_add_n and mp_mod_sub_n, but the correction by M is
+ * masked by carry or borrow instead of branch, thus the sequence of
+ * operations does not depend on X and Y.
+ */
+static inline
+void mp_mod_add_n_sec (digit_t *r, const digit_t *x, const digit_t *y,
+		       const digit_t *m, size_t len)
+{
+	const char c = mp_add_n (r, x, y, len, 0);
+
+	mp_mod_norm_n_sec (r, r, m, len, c);
+}
+
+static inline
+void mp_mod_sub_n_sec (digit_t *r, const digit_t *x, const digit_t *y,
+		       const digit_t *m, size_t len)
+{
+	const digit_t mask = 0 - (digit_t) mp_sub_n (r, x, y, len, 0);
+	char c = 0;
+	size_t j;
+
+	for (j = 0; j < len; ++j)
+		c = mp_digit_adc (&r[j], r[j], m[j] & mask, c);
+}
+
 #endif  /* MP_MOD_H */
@@ -0,0 +1,86 @@
+/*
+ * MP Core Modular Arithmetics: Fixed-Size Montgomery Multiplication
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef MP_MONT_FIXED_H
+#define MP_MONT_FIXED_H  1
+
+#include <mp/compiler.h>
+#include <mp/digit.h>
+
+/*
+ * Macro MP_MONT_DIGITS returns the number of digits for modulus of the
+ * given bit length.
+ *
+ * Macro MP_MONT_MUL_FIXED defines function name (r, x, y, m, mu) which
+ * does the same thing as function mp_mont_mul_n with len = MP_MONT_DIGITS
+ * (bits) known at compile time: loops over digits are fully unrolled and
+ * the accumulator is kept in local array, thus it can be kept in registers
+ * for small moduli. If flat is non-zero, then the outer loop is unrolled
+ * too to get straight-line code, use it for small moduli only to limit
+ * code size. The final subtraction is branch-free. Result is stored at the
+ * end, thus R may overlap X or Y. Constraints: X < M, Y < M.
+ */
+#define MP_MONT_DIGITS(bits)  (((bits) + MP_DIGIT_BITS - 1) / MP_DIGIT_BITS)
+
+#define MP_MONT_MUL_FIXED(name, bits, flat)				\
+static void name (digit_t *r, const digit_t *x, const digit_t *y,	\
+		  const digit_t *m, digit_t mu)				\
+{									\
+	enum { n = MP_MONT_DIGITS (bits) };				\
+	digit_t t[n], s[n], yi, q, h, l, h1, h2, mask;			\
+	char c = 0, b = 0;						\
+	size_t i, j;							\
+									\
+	MP_UNROLL (n)							\
+	for (j = 0; j < n; ++j)						\
+		t[j] = 0;						\
+									\
+	MP_UNROLL ((flat) ? n : 1)					\
+	for (i = 0; i < n; ++i) {					\
+		yi = y[i];						\
+									\
+		mp_digit_fma (&h1, &l, x[0], yi, t[0]);			\
+		q = l * mu;						\
+		mp_digit_fma (&h2, &l, m[0], q, l);			\
+									\
+		MP_UNROLL (n)						\
+		for (j = 1; j < n; ++j) {				\
+			mp_digit_fma (&h, &l, x[j], yi, t[j]);		\
+			h1 = h + mp_digit_add (&l, l, h1);		\
+									\
+			mp_digit_fma (&h, &l, m[j], q, l);		\
+			h2 = h + mp_digit_add (&t[j - 1], l, h2);	\
+		}							\
+									\
+		c = mp_digit_add (&l, h1, h2) +				\
+		    mp_digit_add (&t[n - 1], l, c);			\
+	}								\
+									\
+	MP_UNROLL (n)							\
+	for (j = 0; j < n; ++j)						\
+		b = mp_digit_sbb (&s[j], t[j], m[j], b);		\
+									\
+	mask = 0 - (digit_t) ((c | (b ^ 1)) & 1);			\
+									\
+	MP_UNROLL (n)							\
+	for (j = 0; j < n; ++j)						\
+		r[j] = (s[j] & mask) | (t[j] & ~mask);			\
+}
+
+/*
+ * Function mp_mont_fixed_flat returns non-zero if mp_mont_mul_n has
+ * straight-line kernel for modulus of len digits. Such kernel is faster
+ * than mp_mont_sqr_n for squaring also.
+ */
+static inline int mp_mont_fixed_flat (size_t len)
+{
+	return	len == MP_MONT_DIGITS (256) || len == MP_MONT_DIGITS (384) ||
+		len == MP_MONT_DIGITS (521);
+}
+
+#endif  /* MP_MONT_FIXED_H */
@@ -10,6 +10,7 @@
 #define MP_MONT_MUL_H  1
 
 #include <mp/mod.h>
+#include <mp/mul.h>
 
 /*
  * Constraints for all Montgomery multiplication methods: M is odd.
@@ -38,15 +39,64 @@
  *
  * Function mp_mont_mul_n multiplies (x, len) by (y, len) module (m, len),
  * where all X, Y and R are in Montgomery representation, and stores result
- * into (r, len). Constraints: X < M, Y < M.
+ * into (r, len). Constraints: X < M, Y < M. For moduli of 256, 384, 521,
+ * 2048 and 4096 bits it dispatches to fully unrolled fixed-size kernels,
+ * see mp/mont-fixed.h.
+ *
+ * Function mp_mont_sqr_n does the same thing as function mp_mont_mul_n
+ * with Y = X, but computes cross products only once. Constraint: X < M.
+ *
+ * Both functions are constant-flow: final subtraction is masked, and
+ * squaring uses school book, Karatsuba or Toom-3 algorithms only, see
+ * mp/mul.h.
  *
  * Function mp_mont_pow_n computes R * (X^Y) modulo M, where R = (r, len),
  * X = (x, len), Y = (y, len) and M = (m, len), and stores result into R.
- * Constraints: R and X operands are in Montgomery representation.
+ * Constraints: R and X operands are in Montgomery representation. It uses
+ * left-to-right sliding window method.
+ *
+ * Function mp_mont_pow_window returns the window width in bits to use for
+ * exponent of the given bit length.
  *
  * Function mp_mont_pow_n_sec does the same thing as function mp_mont_pow_n,
  * but the number of operations depends only on the length of the numbers
- * (len) to prevent timing and Flush+Reload side-channel attacks.
+ * (len) to prevent timing and Flush+Reload side-channel attacks. It uses
+ * fixed window method, the table of powers is read with full masked scan.
+ * Constraint: the most significant digit of M is not zero.
+ *
+ * Function mp_mont_pow_multi_n computes R * X[0]^Y[0] ... X[n-1]^Y[n-1]
+ * modulo M, where X[i] = (x + i * len, len), Y[i] = (y + i * len, len)
+ * and n = count, and stores result into R. Squarings are shared between
+ * all bases: it uses interleaved sliding windows (Straus method) for
+ * few bases, or bucket method (Pippenger) for many ones, whichever takes
+ * fewer multiplications. Returns non-zero on success, or zero if memory
+ * allocation failed. Constraints: R and X[i] operands are in Montgomery
+ * representation.
+ *
+ * Function mp_mont_inv_n computes R = X^-1 modulo M, where R = (r, len),
+ * X = (x, len) and M = (m, len), both X and R are in Montgomery
+ * representation, and ro = R^2 mod M. Returns non-zero on success, or zero
+ * if X is not invertible or memory allocation failed. It uses Bernstein-
+ * Yang constant-time divsteps batched by MP_DIGIT_BITS - 2, the number of
+ * operations depends only on len. Works for any odd M, not for primes
+ * only. Constraint: X < M.
+ *
+ * Function mp_mont_inv_batch computes inverses of count residues X[i] =
+ * (x + i * len, len) modulo M in Montgomery representation, and stores
+ * them into R[i] = (r + i * len, len) using one inversion and 3 (count - 1)
+ * multiplications. It uses caller-provided workspace (ws) of size returned
+ * by mp_mont_inv_batch_itch. Returns non-zero on success, or zero if any
+ * of X[i] is not invertible, results are undefined in this case.
+ * Constraints: X[i] < M, R and X do not overlap.
+ *
+ * Functions with _ws suffix do the same as their counterparts without it,
+ * but use caller-provided workspace (ws), thus they never allocate memory.
+ * The counterparts allocate workspace with mp_alloc, and fall back to
+ * slower methods which need at most 2 len digits of stack if allocation
+ * failed, except mp_mont_inv_n which reports failure. Functions
+ * mp_mont_ro_itch, mp_mont_sqr_itch and mp_mont_pow_itch return the
+ * required size of workspace in digits for mp_mont_ro*, mp_mont_sqr_n and
+ * mp_mont_pow_n* respectively.
  */
 digit_t mp_mont_mu  (digit_t m0);
 void mp_mont_ro     (digit_t *r, const digit_t *m, size_t len);
@@ -54,6 +104,8 @@ void mp_mont_ro_gen (digit_t *r, const digit_t *m, size_t len);
 
 void mp_mont_mul_n  (digit_t *r, const digit_t *x, const digit_t *y,
 		     const digit_t *m, size_t len, digit_t mu);
+void mp_mont_sqr_n  (digit_t *r, const digit_t *x,
+		     const digit_t *m, size_t len, digit_t mu);
 void mp_mont_pull_n (digit_t *r, const digit_t *x,
 		     const digit_t *m, size_t len, digit_t mu);
 static inline
@@ -68,4 +120,188 @@ void mp_mont_pow_n     (digit_t *r, const digit_t *x, const digit_t *y,
 void mp_mont_pow_n_sec (digit_t *r, const digit_t *x, const digit_t *y,
 			const digit_t *m, size_t len, digit_t mu);
 
+int  mp_mont_pow_multi_n (digit_t *r, const digit_t *x, const digit_t *y,
+			  size_t count, const digit_t *m, size_t len,
+			  digit_t mu);
+
+int  mp_mont_inv_n (digit_t *r, const digit_t *x, const digit_t *ro,
+		    const digit_t *m, size_t len, digit_t mu);
+
+static inline size_t mp_mont_ro_itch (size_t len)
+{
+	return len * 3 + 1;
+}
+
+static inline size_t mp_mont_sqr_itch (size_t len)
+{
+	return len * 2 + mp_sqr_itch (len);
+}
+
+static inline size_t mp_mont_pow_window (size_t bits)
+{
+	return	bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 :
+		bits >  23 ? 3 : bits >   7 ? 2 : 1;
+}
+
+static inline size_t mp_mont_pow_itch (size_t len)
+{
+	const size_t w = mp_mont_pow_window (len * MP_DIGIT_BITS);
+
+	return len * (2 + ((size_t) 1 << w)) + mp_mont_sqr_itch (len);
+}
+
+static inline size_t mp_mont_inv_itch (size_t len)
+{
+	return (len + 1) * 7;
+}
+
+static inline size_t mp_mont_inv_batch_itch (size_t len)
+{
+	return len + mp_mont_inv_itch (len);
+}
+
+void mp_mont_ro_ws     (digit_t *r, const digit_t *m, size_t len, digit_t *ws);
+void mp_mont_ro_gen_ws (digit_t *r, const digit_t *m, size_t len, digit_t *ws);
+
+void mp_mont_sqr_n_ws  (digit_t *r, const digit_t *x,
+			const digit_t *m, size_t len, digit_t mu, digit_t *ws);
+
+void mp_mont_pow_n_ws     (digit_t *r, const digit_t *x, const digit_t *y,
+			   const digit_t *m, size_t len, digit_t mu,
+			   digit_t *ws);
+void mp_mont_pow_n_sec_ws (digit_t *r, const digit_t *x, const digit_t *y,
+			   const digit_t *m, size_t len, digit_t mu,
+			   digit_t *ws);
+
+int  mp_mont_inv_n_ws (digit_t *r, const digit_t *x, const digit_t *ro,
+		       const digit_t *m, size_t len, digit_t mu, digit_t *ws);
+
+int  mp_mont_inv_batch (digit_t *r, const digit_t *x, size_t count,
+			const digit_t *ro, const digit_t *m, size_t len,
+			digit_t mu, digit_t *ws);
+
+/*
+ * Montgomery context: modulus M = (m, len), mu, ro = R^2 mod M, one = R mod
+ * M and scratch area for operations, all in one memory block. Context
+ * computed once per modulus and then reused. Note that the context is not
+ * thread-safe due to shared scratch area.
+ *
+ * Function mp_mont_init initializes context o for modulus (m, len), and
+ * returns non-zero on success, or zero if memory allocation failed.
+ * Constraints: M is odd, the most significant digit of M is not zero.
+ *
+ * Function mp_mont_fini releases resources of context o.
+ *
+ * Functions mp_mont_push, mp_mont_pull, mp_mont_mul and mp_mont_sqr do
+ * the same things as their counterparts with _n suffix, but take modulus
+ * from context o.
+ *
+ * Function mp_mont_pow computes X^Y modulo M, where R = (r, len), X = (x,
+ * len), Y = (y, len), and stores result into R. Constraint: X operand is
+ * in Montgomery representation, result is in Montgomery representation
+ * as well.
+ *
+ * Function mp_mont_pow_sec does the same thing as function mp_mont_pow,
+ * but in a secure manner of function mp_mont_pow_n_sec.
+ *
+ * Function mp_mont_pow_multi computes X[0]^Y[0] ... X[n-1]^Y[n-1] modulo M
+ * as function mp_mont_pow_multi_n does, and stores result into R.
+ *
+ * Function mp_mont_inv does the same thing as function mp_mont_inv_n, but
+ * takes modulus from context o.
+ */
+struct mp_mont_ctx {
+	digit_t *m, *ro, *one, *ws;
+	size_t len;
+	digit_t mu;
+};
+
+int  mp_mont_init (struct mp_mont_ctx *o, const digit_t *m, size_t len);
+void mp_mont_fini (struct mp_mont_ctx *o);
+
+static inline
+void mp_mont_push (const struct mp_mont_ctx *o, digit_t *r, const digit_t *x)
+{
+	mp_mont_mul_n (r, x, o->ro, o->m, o->len, o->mu);
+}
+
+static inline
+void mp_mont_pull (const struct mp_mont_ctx *o, digit_t *r, const digit_t *x)
+{
+	mp_mont_pull_n (r, x, o->m, o->len, o->mu);
+}
+
+static inline
+void mp_mont_mul (const struct mp_mont_ctx *o, digit_t *r, const digit_t *x,
+		  const digit_t *y)
+{
+	mp_mont_mul_n (r, x, y, o->m, o->len, o->mu);
+}
+
+static inline
+void mp_mont_sqr (const struct mp_mont_ctx *o, digit_t *r, const digit_t *x)
+{
+	mp_mont_sqr_n_ws (r, x, o->m, o->len, o->mu, o->ws);
+}
+
+void mp_mont_pow     (const struct mp_mont_ctx *o, digit_t *r,
+		      const digit_t *x, const digit_t *y);
+void mp_mont_pow_sec (const struct mp_mont_ctx *o, digit_t *r,
+		      const digit_t *x, const digit_t *y);
+int  mp_mont_pow_multi (const struct mp_mont_ctx *o, digit_t *r,
+			const digit_t *x, const digit_t *y, size_t count);
+int  mp_mont_inv     (const struct mp_mont_ctx *o, digit_t *r,
+		      const digit_t *x);
+
+/*
+ * Fixed-base exponentiation: Lim-Lee comb table for base X in Montgomery
+ * representation, computed once per base and then reused for any number
+ * of exponents. The comb has h teeth spaced by d = ceil (bits / h) bits,
+ * the table holds 2^h entries, and exponentiation costs only d squarings
+ * and d multiplications. The comb uses Montgomery context c and has its
+ * own scratch area, thus it is not thread-safe as well.
+ *
+ * Function mp_mont_comb_init computes comb o with h teeth for base (x,
+ * c->len) and exponents up to bits long, and returns non-zero on success,
+ * or zero if parameters are out of range or memory allocation failed.
+ * Constraints: 0 < h < MP_DIGIT_BITS, bits <= c->len * MP_DIGIT_BITS.
+ *
+ * Function mp_mont_comb_teeth returns the number of teeth to use for
+ * exponents of the given bit length, for mp_mont_comb_pow if sec is zero,
+ * or for mp_mont_comb_pow_sec otherwise: the latter scans the whole table
+ * for every column, thus it prefers smaller tables.
+ *
+ * Function mp_mont_comb_fini releases resources of comb o.
+ *
+ * Function mp_mont_comb_pow computes X^Y modulo M, where Y = (y, len), and
+ * stores result into R = (r, len) in Montgomery representation.
+ * Constraint: Y < 2^bits.
+ *
+ * Function mp_mont_comb_pow_sec does the same thing as function
+ * mp_mont_comb_pow, but the number of operations depends only on bits,
+ * the table is read with full masked scan for every comb column to
+ * prevent timing and Flush+Reload side-channel attacks.
+ */
+struct mp_mont_comb {
+	const struct mp_mont_ctx *c;
+	digit_t *T, *t;
+	size_t bits, h, d;
+};
+
+int  mp_mont_comb_init (struct mp_mont_comb *o, const struct mp_mont_ctx *c,
+			const digit_t *x, size_t bits, size_t h);
+void mp_mont_comb_fini (struct mp_mont_comb *o);
+
+static inline size_t mp_mont_comb_teeth (size_t bits, int sec)
+{
+	const size_t w = mp_mont_pow_window (bits);
+
+	return sec ? w : w + 2 < 8 ? w + 2 : 8;
+}
+
+void mp_mont_comb_pow     (const struct mp_mont_comb *o, digit_t *r,
+			   const digit_t *y);
+void mp_mont_comb_pow_sec (const struct mp_mont_comb *o, digit_t *r,
+			   const digit_t *y);
+
 #endif  /* MP_MONT_MUL_H */
@@ -11,6 +11,19 @@
 
 #include <mp/types.h>
 
+/*
+ * Operand length starting from which mp_mul and mp_sqr use three-prime
+ * number-theoretic transform.
+ *
+ * The school book, Karatsuba and Toom-3 algorithms are constant-flow:
+ * the sequence of operations and memory accesses depends on operand
+ * lengths only. The transform reduces residues with conditional
+ * corrections, thus it is not guaranteed to be constant-flow.
+ */
+#ifndef MP_NTT_CUTOFF
+#define MP_NTT_CUTOFF  7000
+#endif
+
 /*
  * Function mp_mul_1 multiplies (x, len) by y, stores result into (r, len),
  * and returns the carry value.
@@ -26,6 +39,25 @@
  *
  * Function mp_mul_sb does the same as mp_mul, only using school book
  * algorithm exclusively. Exported for tests only.
+ *
+ * Function mp_sqr squares (x, len), stores result into (r, len * 2).
+ * Function mp_mul calls it when both operands are the same number.
+ * Constraint: len > 0.
+ *
+ * Function mp_sqr_sb does the same as mp_sqr, only using school book
+ * algorithm exclusively. Exported for tests only.
+ *
+ * Function mp_mul_ntt does the same as mp_mul, only using three-prime
+ * number-theoretic transform, and returns nonzero on success. It fails
+ * if operands are too long for the transform or there is no memory for
+ * the workspace. Exported for tests only.
+ *
+ * Functions mp_mul_ws, mp_sqr_ws and mp_mul_ntt_ws do the same as their
+ * counterparts without suffix, but use caller-provided workspace (ws)
+ * instead of allocating one, thus they never allocate memory. Functions
+ * mp_mul_itch, mp_sqr_itch and mp_mul_ntt_itch return the required size
+ * of workspace in digits. Note that mp_mul_ntt_itch returns zero if the
+ * operands are too long for the transform.
  */
 digit_t mp_mul_1    (digit_t *r, const digit_t *x, size_t len, digit_t y);
 digit_t mp_addmul_1 (digit_t *r, const digit_t *x, size_t len, digit_t y,
@@ -37,5 +69,20 @@ void    mp_mul      (digit_t *r, const digit_t *x, size_t xlen,
 				 const digit_t *y, size_t ylen);
 void    mp_mul_sb   (digit_t *r, const digit_t *x, size_t xlen,
 				 const digit_t *y, size_t ylen);
+void    mp_sqr      (digit_t *r, const digit_t *x, size_t len);
+void    mp_sqr_sb   (digit_t *r, const digit_t *x, size_t len);
+int     mp_mul_ntt  (digit_t *r, const digit_t *x, size_t xlen,
+				 const digit_t *y, size_t ylen);
+
+size_t  mp_mul_itch (size_t xlen, size_t ylen);
+void    mp_mul_ws   (digit_t *r, const digit_t *x, size_t xlen,
+				 const digit_t *y, size_t ylen, digit_t *ws);
+size_t  mp_sqr_itch (size_t len);
+void    mp_sqr_ws   (digit_t *r, const digit_t *x, size_t len, digit_t *ws);
+
+size_t  mp_mul_ntt_itch (size_t xlen, size_t ylen);
+void    mp_mul_ntt_ws   (digit_t *r, const digit_t *x, size_t xlen,
+				     const digit_t *y, size_t ylen,
+				     digit_t *ws);
 
 #endif  /* MP_MUL_H */
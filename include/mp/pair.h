@@ -74,4 +74,43 @@ static inline digit_t mp_pair_divapprox (digit_t n1, digit_t n0, digit_t r)
 	return q1;
 }
 
+/*
+ * Function mp_digit_invert calculates the value of (B^2 - 1) / d - B. The
+ * divisor d must be normalized, i.e. the most significant bit of d is set.
+ *
+ * Function mp_pair_div_pi divides pair (n1 * B + n0) by d, stores quotient
+ * into q and remainder into r, using multiplications only (Moller and
+ * Granlund). The v value should be precalculated with mp_digit_invert.
+ * Constraints: d is normalized, n1 < d.
+ */
+static inline digit_t mp_digit_invert (digit_t d)
+{
+	digit_t v, r;
+
+	mp_digit_div (&v, &r, ~d, ~(digit_t) 0, d);
+	return v;
+}
+
+static inline void mp_pair_div_pi (digit_t *q, digit_t *r,
+				   digit_t n1, digit_t n0, digit_t d, digit_t v)
+{
+	digit_t q1, q0, rem, mask;
+
+	mp_digit_mul (&q1, &q0, v, n1);
+	mp_pair_add (&q1, &q0, q1, q0, n1 + 1, n0);
+
+	rem  = n0 - q1 * d;
+	mask = 0 - (digit_t) (rem > q0);  /* unpredictable, thus masked */
+	q1  += mask;
+	rem += mask & d;
+
+	if (rem >= d) {  /* unlikely */
+		++q1;
+		rem -= d;
+	}
+
+	*q = q1;
+	*r = rem;
+}
+
 #endif  /* MP_PAIR_H */
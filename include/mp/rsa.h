@@ -0,0 +1,55 @@
+/*
+ * MP Core RSA Private Operation with Chinese Remainder Theorem
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef MP_RSA_H
+#define MP_RSA_H  1
+
+#include <mp/mont-mul.h>
+
+/*
+ * RSA private key in CRT form: Montgomery contexts for primes p > q and
+ * for modulus N = p q, dP = d mod (p - 1), dQ = d mod (q - 1), qInv =
+ * q^-1 mod p in Montgomery representation, R^3 mod p and R^3 mod q to
+ * convert input without division, optional public exponent e for result
+ * verification, and scratch area for operations. Computed once per key
+ * and then reused. Note that the key is not thread-safe due to shared
+ * scratch areas.
+ *
+ * Function mp_rsa_init initializes key o for primes (p, len), (q, len) and
+ * private exponent (d, 2 len), and returns non-zero on success, or zero if
+ * memory allocation failed or q is not invertible modulo p. If e is not
+ * NULL then the public exponent (e, 2 len) is stored to verify results.
+ * Constraints: p and q are odd, the most significant digits of p and q
+ * are not zero. Note that key setup uses division and thus it is not
+ * constant-time: do it once per key in a trusted environment.
+ *
+ * Function mp_rsa_fini releases resources of key o.
+ *
+ * Function mp_rsa_crt computes R = X^d modulo N with two half-size secure
+ * exponentiations modulo p and q, and Garner recombination R = mq + q h,
+ * where h = qInv (mp - mq) mod p. Reductions modulo p and q are done with
+ * Montgomery multiplications and masked corrections, thus the sequence of
+ * operations does not depend on X, p, q or d. If the key has public
+ * exponent, then the result is verified against fault attacks: R^e must
+ * be X. Returns non-zero on success, or zero and R = 0 if verification
+ * failed.
+ * R = (r, 2 len), X = (x, 2 len). Constraint: X < N.
+ */
+struct mp_rsa {
+	struct mp_mont_ctx p, q, n;
+	digit_t *dp, *dq, *qinv, *r3p, *r3q, *e, *ws;
+	size_t len;
+};
+
+int  mp_rsa_init (struct mp_rsa *o, const digit_t *p, const digit_t *q,
+		  size_t len, const digit_t *d, const digit_t *e);
+void mp_rsa_fini (struct mp_rsa *o);
+
+int  mp_rsa_crt  (const struct mp_rsa *o, digit_t *r, const digit_t *x);
+
+#endif  /* MP_RSA_H */
@@ -0,0 +1,69 @@
+/*
+ * MP Core Modular Arithmetics: Special Form Modulus Reduction
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef MP_SOLINAS_H
+#define MP_SOLINAS_H  1
+
+#include <mp/types.h>
+
+/*
+ * Special form reduction context for modulus M = 2^k - C, where k is the
+ * bit length of M: modulus, C, reduction terms and scratch area, all in
+ * one memory block. Two forms are supported:
+ *
+ *  1. pseudo-Mersenne: C fits into one digit and C^2 < 2^k, e.g. 2^255 -
+ *     19, 2^521 - 1 or 2^256 - 2^32 - 977. Reduction is three folds X =
+ *     H 2^k + L -> L + H C (first two of them at digit boundary if C
+ *     shifted there still fits into digit) with fixed operand lengths and
+ *     one masked subtraction, the sequence of operations depends on len
+ *     only;
+ *
+ *  2. generalized Mersenne (Solinas): k is a multiple of 32 up to 1024,
+ *     and C is a sum of signed small multiples of powers of 2^32, e.g. NIST
+ *     P-224, P-256 and P-384. Every high 32-bit chunk of X is congruent
+ *     to a fixed signed combination of low chunks, thus reduction is one
+ *     pass of additions over the precomputed sparse matrix of small
+ *     coefficients, then small signed carry is folded back until it
+ *     vanishes. Note that the number of carry folds depends on X.
+ *
+ * Note that the context is not thread-safe due to shared scratch area.
+ *
+ * Function mp_solinas_init initializes context o for modulus (m, len),
+ * and returns non-zero on success, or zero if M is not of supported form
+ * or memory allocation failed. Constraints: M is odd, len > 1, the most
+ * significant digit of M is not zero.
+ *
+ * Function mp_solinas_fini releases resources of context o.
+ *
+ * Function mp_solinas_reduce computes X mod M, where X = (x, 2 len), and
+ * stores result into (r, len). Constraint: X < 2^(2k), e.g. X is a product
+ * of two residues modulo M.
+ *
+ * Functions mp_solinas_mul and mp_solinas_sqr compute X Y mod M and X^2
+ * mod M with full product by mp_mul or mp_sqr followed by the reduction,
+ * where R = (r, len), X = (x, len), Y = (y, len). Constraints: X < M,
+ * Y < M. Result may overlap operands.
+ */
+struct mp_solinas {
+	digit_t *m, *c, *ws;
+	int *t;			/* reduction matrix or NULL */
+	size_t len, bits;
+};
+
+int  mp_solinas_init (struct mp_solinas *o, const digit_t *m, size_t len);
+void mp_solinas_fini (struct mp_solinas *o);
+
+void mp_solinas_reduce (const struct mp_solinas *o, digit_t *r,
+			const digit_t *x);
+
+void mp_solinas_mul (const struct mp_solinas *o, digit_t *r,
+		     const digit_t *x, const digit_t *y);
+void mp_solinas_sqr (const struct mp_solinas *o, digit_t *r,
+		     const digit_t *x);
+
+#endif  /* MP_SOLINAS_H */
@@ -0,0 +1,52 @@
+/*
+ * MP Core Allocation
+ *
+ * Copyright (c) 2014-2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdlib.h>
+
+#include <mp/alloc.h>
+#include <mp/compiler.h>
+
+#ifndef MP_THREAD_LOCAL
+#define MP_THREAD_LOCAL
+#endif
+
+static MP_THREAD_LOCAL const struct mp_allocator *mp_allocator;
+
+const struct mp_allocator *mp_set_allocator (const struct mp_allocator *o)
+{
+	const struct mp_allocator *prev = mp_allocator;
+
+	mp_allocator = o;
+	return prev;
+}
+
+digit_t *mp_alloc (size_t len)
+{
+	const struct mp_allocator *o = mp_allocator;
+	const size_t size = sizeof (digit_t) * len;
+
+	return o == NULL ? malloc (size) : o->alloc (o->ctx, size);
+}
+
+digit_t *mp_realloc (digit_t *p, size_t len)
+{
+	const struct mp_allocator *o = mp_allocator;
+	const size_t size = sizeof (digit_t) * len;
+
+	return o == NULL ? realloc (p, size) : o->realloc (o->ctx, p, size);
+}
+
+void mp_free (digit_t *p)
+{
+	const struct mp_allocator *o = mp_allocator;
+
+	if (o == NULL)
+		free (p);
+	else
+		o->free (o->ctx, p);
+}
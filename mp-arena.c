@@ -0,0 +1,173 @@
+/*
+ * MP Core Arena Allocator
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <mp/alloc.h>
+
+#define MP_ARENA_CHUNK	65536	/* default chunk size */
+#define MP_ARENA_MIN	32	/* size of smallest class */
+
+struct mp_arena_chunk {
+	struct mp_arena_chunk *next;
+	size_t size;
+};
+
+/*
+ * Every block starts with a header, free blocks are linked via payload
+ */
+struct mp_arena_head {
+	size_t index;			/* size class	*/
+	size_t size;			/* payload size	*/
+};
+
+struct mp_arena_free {
+	struct mp_arena_free *next;
+};
+
+static size_t mp_arena_class (size_t size)
+{
+	size_t i, n;
+
+	for (i = 0, n = MP_ARENA_MIN; i < MP_ARENA_CLASSES; ++i, n <<= 1)
+		if (size <= n)
+			break;
+
+	return i;
+}
+
+static void *mp_arena_chunk (struct mp_arena *o, size_t size)
+{
+	struct mp_arena_chunk *c;
+
+	if ((c = malloc (sizeof (*c) + size)) == NULL)
+		return NULL;
+
+	c->next  = o->chunk;
+	c->size  = size;
+	o->chunk = c;
+	return c + 1;
+}
+
+static void *mp_arena_bump (struct mp_arena *o, size_t size)
+{
+	char *p;
+
+	if (size > MP_ARENA_CHUNK / 2)
+		return mp_arena_chunk (o, size);  /* dedicated chunk */
+
+	if (size > o->avail) {
+		if ((p = mp_arena_chunk (o, MP_ARENA_CHUNK)) == NULL)
+			return NULL;
+
+		o->next  = p;
+		o->avail = MP_ARENA_CHUNK;
+	}
+
+	p = o->next;
+	o->next  += size;
+	o->avail -= size;
+	return p;
+}
+
+static void *mp_arena_alloc (void *ctx, size_t size)
+{
+	struct mp_arena *o = ctx;
+	const size_t need = sizeof (struct mp_arena_head) + size;
+	const size_t i = mp_arena_class (need);
+	struct mp_arena_head *h;
+	struct mp_arena_free *f;
+
+	if (i < MP_ARENA_CLASSES && (f = o->pool[i]) != NULL) {
+		o->pool[i] = f->next;
+		h = (void *) ((char *) f - sizeof (*h));
+	}
+	else {
+		h = mp_arena_bump (o, i < MP_ARENA_CLASSES ?
+				      (size_t) MP_ARENA_MIN << i : need);
+		if (h == NULL)
+			return NULL;
+
+		h->index = i;
+	}
+
+	h->size = size;
+	return h + 1;
+}
+
+static void mp_arena_free (void *ctx, void *p)
+{
+	struct mp_arena *o = ctx;
+	struct mp_arena_head *h;
+	struct mp_arena_free *f = p;
+
+	if (p == NULL)
+		return;
+
+	h = (struct mp_arena_head *) p - 1;
+
+	if (h->index >= MP_ARENA_CLASSES)
+		return;  /* dedicated chunks are released by fini */
+
+	f->next = o->pool[h->index];
+	o->pool[h->index] = f;
+}
+
+static void *mp_arena_realloc (void *ctx, void *p, size_t size)
+{
+	struct mp_arena_head *h;
+	void *q;
+
+	if (p == NULL)
+		return mp_arena_alloc (ctx, size);
+
+	h = (struct mp_arena_head *) p - 1;
+
+	if (h->index < MP_ARENA_CLASSES &&
+	    sizeof (*h) + size <= (size_t) MP_ARENA_MIN << h->index) {
+		h->size = size;
+		return p;
+	}
+
+	if ((q = mp_arena_alloc (ctx, size)) == NULL)
+		return NULL;
+
+	memcpy (q, p, h->size < size ? h->size : size);
+	mp_arena_free (ctx, p);
+	return q;
+}
+
+void mp_arena_init (struct mp_arena *o)
+{
+	size_t i;
+
+	o->allocator.alloc   = mp_arena_alloc;
+	o->allocator.realloc = mp_arena_realloc;
+	o->allocator.free    = mp_arena_free;
+	o->allocator.ctx     = o;
+
+	o->chunk = NULL;
+	o->next  = NULL;
+	o->avail = 0;
+
+	for (i = 0; i < MP_ARENA_CLASSES; ++i)
+		o->pool[i] = NULL;
+}
+
+void mp_arena_fini (struct mp_arena *o)
+{
+	struct mp_arena_chunk *c, *next;
+
+	for (c = o->chunk; c != NULL; c = next) {
+		next = c->next;
+		free (c);
+	}
+
+	mp_arena_init (o);
+}
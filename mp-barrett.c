@@ -0,0 +1,173 @@
+/*
+ * MP Core Modular Arithmetics: Barrett Reduction
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/barrett.h>
+#include <mp/core.h>
+#include <mp/digit.h>
+#include <mp/mul.h>
+#include <mp/pair.h>
+#include <mp/shift.h>
+#include <mp/unit.h>
+
+#define MP_MULLO_CUTOFF	40	/* use truncated schoolbook below */
+#define MP_MULHI_CUTOFF	40
+
+/*
+ * Computes low xlen digits of (x, xlen) * (y, ylen) into (r, xlen).
+ * Constraints: xlen >= ylen > 0. Workspace: mp_mul_itch (xlen, ylen)
+ * plus (xlen + ylen) digits.
+ */
+static void mp_mul_lo (digit_t *r, const digit_t *x, size_t xlen,
+		       const digit_t *y, size_t ylen, digit_t *ws)
+{
+	size_t i;
+
+	if (ylen >= MP_MULLO_CUTOFF) {
+		mp_mul_ws (ws, x, xlen, y, ylen, ws + xlen + ylen);
+		mp_copy (r, ws, xlen);
+		return;
+	}
+
+	mp_mul_1 (r, x, xlen, y[0]);
+
+	for (i = 1; i < ylen; ++i)
+		mp_addmul_1 (r + i, x, xlen - i, y[i], 0);
+}
+
+/*
+ * Computes (x, len) * (y, len) into (r, 2 len) with columns below len - 2
+ * dropped: the high len + 1 digits are less than the exact ones by at most
+ * one. Workspace: mp_mul_itch (len, len).
+ */
+static void mp_mul_hi (digit_t *r, const digit_t *x, const digit_t *y,
+		       size_t len, digit_t *ws)
+{
+	const size_t k = len - 2;
+	size_t i, s;
+
+	if (len < MP_MULHI_CUTOFF) {
+		mp_zero (r + k, len + 2);
+
+		for (i = 0; i < len; ++i) {
+			s = i < k ? k - i : 0;
+			r[i + len] = mp_addmul_1 (r + i + s, x + s, len - s,
+						  y[i], 0);
+		}
+
+		return;
+	}
+
+	mp_mul_ws (r, x, len, y, len, ws);
+}
+
+/*
+ * Computes V = floor (B^2n / D) by Newton iteration V' = V + V E / B^2n,
+ * where E = B^2n - D V. The initial approximation is taken from two top
+ * digits of D, every step keeps V below the true value and doubles the
+ * number of correct digits, the last few units are corrected linearly.
+ * Constraint: the most significant bit of D is set.
+ */
+static void mp_barrett_recip (digit_t *v, const digit_t *d, size_t n,
+			      digit_t *ws)
+{
+	digit_t *E = ws, *P = E + 2 * n;
+
+	ws = P + 3 * n + 1;
+
+	mp_zero (v, n + 1);
+	v[n]     = 1;
+	v[n - 1] = mp_pair_invert (d[n - 1], n > 1 ? d[n - 2] : 0);
+
+	for (;;) {
+		mp_mul_ws (P, v, n + 1, d, n, ws);
+		mp_neg (E, P, 2 * n);
+
+		mp_mul_ws (P, E, 2 * n, v, n + 1, ws);
+
+		if (mp_normalize (P + 2 * n, n + 1) == 0)
+			break;
+
+		mp_add_n (v, v, P + 2 * n, n + 1, 0);
+	}
+
+	while (mp_normalize (E + n, n) != 0 || mp_cmp_n (E, d, n) >= 0) {
+		mp_add_1 (v, v, n + 1, 1);
+		mp_sub (E, E, 2 * n, d, n, 0);
+	}
+}
+
+/*
+ * Reciprocal needs (E, 2n), (P, 3n + 1) and multiplication of 2n by n + 1
+ * digits. Reduction needs (X, 2n), (P, 2n + 2), (T, 2n + 2) and either
+ * multiplication of n + 1 by n + 1 digits or low multiplication of n + 1
+ * by n digits.
+ */
+static size_t mp_barrett_itch (size_t n)
+{
+	return n * 6 + 4 + mp_mul_itch (n * 2 + 1, n + 1);
+}
+
+int mp_barrett_init (struct mp_barrett *o, const digit_t *m, size_t len)
+{
+	const size_t n = len;
+
+	if ((o->d = mp_alloc (n * 2 + 1 + mp_barrett_itch (n))) == NULL)
+		return 0;
+
+	o->v     = o->d + n;
+	o->ws    = o->v + n + 1;
+	o->len   = n;
+	o->shift = mp_digit_clz (m[n - 1]);
+
+	if (o->shift != 0)
+		mp_lshift (o->d, m, n, 0, o->shift);
+	else
+		mp_copy (o->d, m, n);
+
+	mp_barrett_recip (o->v, o->d, n, o->ws);
+	return 1;
+}
+
+void mp_barrett_fini (struct mp_barrett *o)
+{
+	mp_free (o->d);
+}
+
+/*
+ * Classic Barrett reduction of X' = X * 2^shift modulo D: q = floor (floor
+ * (X' / B^(n - 1)) V / B^(n + 1)) underestimates floor (X' / D) by at most
+ * two (three with truncated high product), thus R = X' - q D is computed
+ * modulo B^(n + 1) with the low part of product only, and then corrected
+ * by at most three subtractions.
+ */
+void mp_barrett_reduce (const struct mp_barrett *o, digit_t *r,
+			const digit_t *x)
+{
+	const size_t n = o->len;
+	digit_t *X = o->ws, *P = X + 2 * n, *T = P + 2 * n + 2;
+	digit_t *ws = T + 2 * n + 2;
+
+	if (o->shift != 0)
+		mp_lshift (X, x, 2 * n, 0, o->shift);
+	else
+		mp_copy (X, x, 2 * n);
+
+	mp_mul_hi (P, X + n - 1, o->v, n + 1, ws);
+	mp_mul_lo (T, P + n + 1, n + 1, o->d, n, ws);
+	mp_sub_n (X, X, T, n + 1, 0);
+
+	while (X[n] != 0 || mp_cmp_n (X, o->d, n) >= 0)
+		X[n] -= mp_sub_n (X, X, o->d, n, 0);
+
+	if (o->shift != 0)
+		mp_rshift (r, X, n, 0, o->shift);
+	else
+		mp_copy (r, X, n);
+}
@@ -0,0 +1,48 @@
+/*
+ * MP Core Division by Single Digit with Precomputed Inverse
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/digit.h>
+#include <mp/div.h>
+#include <mp/pair.h>
+
+digit_t mp_div_1_inv (digit_t y)
+{
+	return mp_digit_invert (y << mp_digit_clz (y));
+}
+
+/*
+ * The divisor is normalized as d = y 2^s, and the dividend is shifted left
+ * by s bits on the fly, thus the quotient is the same and the remainder is
+ * multiplied by 2^s.
+ */
+digit_t mp_div_1_pi (digit_t *r, const digit_t *x, size_t len, digit_t y,
+		     digit_t v)
+{
+	const int s = mp_digit_clz (y), t = MP_DIGIT_BITS - s;
+	const digit_t d = y << s;
+	digit_t rem, n;
+	size_t i;
+
+	if (len == 0)
+		return 0;
+
+	if (s == 0) {
+		for (i = len, rem = 0; i > 0; --i)
+			mp_pair_div_pi (r + i - 1, &rem, rem, x[i - 1], d, v);
+
+		return rem;
+	}
+
+	for (i = len - 1, rem = x[i] >> t; i > 0; --i) {
+		n = (x[i] << s) | (x[i - 1] >> t);
+		mp_pair_div_pi (r + i, &rem, rem, n, d, v);
+	}
+
+	mp_pair_div_pi (r, &rem, rem, x[0] << s, d, v);
+	return rem >> s;
+}
@@ -7,6 +7,7 @@
  */
 
 #include <mp/add.h>
+#include <mp/alloc.h>
 #include <mp/div.h>
 #include <mp/pair.h>
 #include <mp/mul.h>
@@ -28,6 +29,135 @@ digit_t mp_div_reduce (digit_t *q, digit_t c, digit_t *r,
 	return r[dlen - 1];
 }
 
+static size_t mp_div_sb (digit_t *q, digit_t *r, size_t nlen,
+			 const digit_t *d, size_t dlen)
+{
+	digit_t c = 0, inv;
+	size_t i, j;
+
+	inv = mp_pair_invert (d[dlen - 1], dlen > 1 ? d[dlen - 2]: 0);
+
+	for (
+		i = nlen - 1, j = nlen - dlen;
+		j > 0;
+		--i, --j
+	) {
+		c = mp_div_reduce (q + j, c, r + j, d, dlen, inv);
+		r[i] = 0;
+	}
+
+	r[i] = mp_div_reduce (q + 0, c, r + 0, d, dlen, inv);
+
+	return i + 1;
+}
+
+/*
+ * Divides (r, 2n) by (d, n), stores low n digits of quotinent into (q, n),
+ * remainder into (r, n), zeroes upper half of r, and returns the high
+ * digit of quotinent (zero or one). Schoolbook base case.
+ */
+static digit_t mp_div_sb_n (digit_t *q, digit_t *r, const digit_t *d,
+			    size_t n)
+{
+	digit_t qh, c, inv;
+	size_t i, j;
+
+	inv = mp_pair_invert (d[n - 1], n > 1 ? d[n - 2]: 0);
+
+	c = mp_div_reduce (&qh, 0, r + n, d, n, inv);
+
+	for (i = 2 * n - 1, j = n - 1; j > 0; --i, --j) {
+		r[i] = 0;
+		c = mp_div_reduce (q + j, c, r + j, d, n, inv);
+	}
+
+	r[i] = 0;
+	mp_div_reduce (q, c, r, d, n, inv);
+	return qh;
+}
+
+/*
+ * Burnikel-Ziegler recursive division: the same as mp_div_sb_n, but the
+ * quotinent is computed in two halves, every half is a recursive division
+ * by the upper part of divisor followed by multiplication of the partial
+ * quotinent by the lower part of divisor and at most two corrections.
+ *
+ * Workspace: (ws, n) for own needs, where the rest of workspace is used
+ * by multiplication, mp_mul_itch (n, n).
+ */
+static digit_t mp_div_dc_n (digit_t *q, digit_t *r, const digit_t *d,
+			    size_t n, digit_t *ws)
+{
+	const size_t lo = n / 2, hi = n - lo;
+	digit_t qh, ql, c;
+
+	if (n < MP_DIV_DC_CUTOFF)
+		return mp_div_sb_n (q, r, d, n);
+
+	/* (r + 2lo, 2hi) / (d + lo, hi) => (q + lo, hi), with remainder */
+	qh = mp_div_dc_n (q + lo, r + 2 * lo, d + lo, hi, ws);
+
+	mp_mul_ws (ws, q + lo, hi, d, lo, ws + n);
+	c = mp_sub_n (r + lo, r + lo, ws, n, 0);
+
+	if (qh != 0)
+		c += mp_sub_n (r + n, r + n, d, lo, 0);
+
+	for (; c != 0; c -= mp_add_n (r + lo, r + lo, d, n, 0))
+		qh -= mp_sub_1 (q + lo, q + lo, hi, 1);
+
+	/* (r + hi, 2lo) / (d + hi, lo) => (q, lo), with remainder */
+	ql = mp_div_dc_n (q, r + hi, d + hi, lo, ws);
+
+	mp_mul_ws (ws, d, hi, q, lo, ws + n);
+	c = mp_sub_n (r, r, ws, n, 0);
+
+	if (ql != 0)
+		c += mp_sub_n (r + lo, r + lo, d, hi, 0);
+
+	for (; c != 0; c -= mp_add_n (r, r, d, n, 0))
+		ql -= mp_sub_1 (q, q, lo, 1);
+
+	return qh + mp_add_1 (q + lo, q + lo, hi, ql);
+}
+
+/*
+ * Divides the top block (r, n + k) by (d, n), where 0 < k <= n, stores
+ * quotinent into (q, k + 1), remainder into (r, n), and zeroes the rest
+ * of r. The same as the halves of mp_div_dc_n: recursive division by the
+ * upper k digits of divisor, multiplication of the partial quotinent by
+ * the lower part of divisor and corrections.
+ *
+ * Workspace: (ws, n) for own needs, where the rest of workspace is used
+ * by multiplication, mp_mul_itch (n, n).
+ */
+static void mp_div_dc_top (digit_t *q, digit_t *r, const digit_t *d,
+			   size_t n, size_t k, digit_t *ws)
+{
+	const size_t lo = n - k;
+	digit_t qh, c;
+
+	/* (r + lo, 2k) / (d + lo, k) => (q, k), with remainder */
+	qh = mp_div_dc_n (q, r + lo, d + lo, k, ws);
+
+	if (lo > 0) {
+		if (k >= lo)
+			mp_mul_ws (ws, q, k, d, lo, ws + n);
+		else
+			mp_mul_ws (ws, d, lo, q, k, ws + n);
+
+		c = mp_sub_n (r, r, ws, n, 0);
+
+		if (qh != 0)
+			c += mp_sub_n (r + k, r + k, d, lo, 0);
+
+		for (; c != 0; c -= mp_add_n (r, r, d, n, 0))
+			qh -= mp_sub_1 (q, q, k, 1);
+	}
+
+	q[k] = qh;
+}
+
 /*
  * Function mp_div divides (n, nlen) by (d, dlen), stores quotinent into
  * (q, nlen - dlen + 1), remainder into (r, nlen), and returns the size
@@ -35,30 +165,34 @@ digit_t mp_div_reduce (digit_t *q, digit_t c, digit_t *r,
  * bit of d is set, and nlen >= dlen > 0. Note that the remainder is not
  * normalized.
  *
+ * For large divisors and quotinents the top block of nlen - k dlen digits
+ * is divided by the upper part of divisor recursively, and then every
+ * next block of dlen quotinent digits computed by the recursive method.
+ *
  * Tip: Normalize n and d, and then shift n and d left by clz(d) before
  * calling the mp_div function.
  */
 size_t mp_div (digit_t *q, digit_t *r, const digit_t *n, size_t nlen,
 				       const digit_t *d, size_t dlen)
 {
-	digit_t c = 0, inv;
-	size_t i, j;
+	size_t k = (nlen - dlen) / dlen, top = nlen - dlen - k * dlen;
+	digit_t *ws;
 
 	if (r != n)
 		mp_copy (r, n, nlen);
 
-	inv = mp_pair_invert (d[dlen - 1], dlen > 1 ? d[dlen - 2]: 0);
+	if (dlen < MP_DIV_DC_CUTOFF || nlen - dlen < MP_DIV_DC_CUTOFF ||
+	    (ws = mp_alloc (dlen + mp_mul_itch (dlen, dlen))) == NULL)
+		return mp_div_sb (q, r, nlen, d, dlen);
 
-	for (
-		i = nlen - 1, j = nlen - dlen;
-		j > 0;
-		--i, --j
-	) {
-		c = mp_div_reduce (q + j, c, r + j, d, dlen, inv);
-		r[i] = 0;
-	}
+	if (top > 0)
+		mp_div_dc_top (q + k * dlen, r + k * dlen, d, dlen, top, ws);
+	else
+		mp_div_sb (q + k * dlen, r + k * dlen, dlen, d, dlen);
 
-	r[i] = mp_div_reduce (q + 0, c, r + 0, d, dlen, inv);
+	while (k-- > 0)
+		mp_div_dc_n (q + k * dlen, r + k * dlen, d, dlen, ws);
 
-	return i + 1;
+	mp_free (ws);
+	return dlen;
 }
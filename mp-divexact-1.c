@@ -0,0 +1,46 @@
+/*
+ * MP Core Division: Exact Division by Single Digit
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/digit.h>
+#include <mp/div.h>
+#include <mp/mont-mul.h>
+
+/*
+ * The even divisor y = y' 2^k is handled by shifting the dividend right
+ * by k bits on the fly, and the remaining odd part y' is inverted modulo
+ * B. The bits shifted out of the dividend must be zero for the exact
+ * division, thus they are merged into the returned value. Division is
+ * done in place if r = x.
+ */
+digit_t mp_divexact_1 (digit_t *r, const digit_t *x, size_t len, digit_t y)
+{
+	const int k = mp_digit_ctz (y);
+	const digit_t inv = 0 - mp_mont_mu (y >>= k);
+	const digit_t mask = ((digit_t) 1 << k) - 1;
+	digit_t e, c, h, l, q, s;
+	size_t i;
+
+	if (len == 0)
+		return 0;
+
+	e = x[0] & mask;  /* non-zero for inexact division */
+
+	for (c = 0, i = 0; i < len; ++i) {
+		s = x[i] >> k;
+
+		if (k > 0 && i + 1 < len)
+			s |= x[i + 1] << (MP_DIGIT_BITS - k);
+
+		c = mp_digit_sub (&l, s, c);
+		r[i] = q = l * inv;
+		mp_digit_mul (&h, &l, q, y);
+		c += h;
+	}
+
+	return c | e;
+}
@@ -0,0 +1,33 @@
+/*
+ * MP Core Division: Exact Division by Three
+ *
+ * Copyright (c) 2018-2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/digit.h>
+#include <mp/div.h>
+
+/*
+ * Function mp_divexact_by3 divides (x, len) by 3, stores result into
+ * (r, len), and returns zero if division is exact. The quotient digits
+ * are obtained by multiplication by 3^-1 mod B, thus no division
+ * instructions are used.
+ */
+digit_t mp_divexact_by3 (digit_t *r, const digit_t *x, size_t len)
+{
+	const digit_t inv = MP_DIGIT_ROOF / 3 * 2 + 1;  /* 3 * inv = 1 mod B */
+	size_t i;
+	digit_t c, q, h, l;
+
+	for (i = 0, c = 0; i < len; ++i) {
+		c = mp_digit_sub (&l, x[i], c);
+		r[i] = q = l * inv;
+
+		mp_digit_mul (&h, &l, q, 3);
+		c += h;
+	}
+
+	return c;
+}
@@ -0,0 +1,47 @@
+/*
+ * MP Core Division: Exact Division
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/add.h>
+#include <mp/div.h>
+#include <mp/mont-mul.h>
+#include <mp/mul.h>
+#include <mp/unit.h>
+
+/*
+ * Jebelean exact division: the quotient digits are found from the least
+ * significant one as q_i = r_i / y_0 mod B, and the quotient itself is
+ * the result modulo B^qlen, thus only the lower qlen digits of the
+ * dividend are updated and only the lower qlen digits of the divisor
+ * are used. The quotient buffer is used as the running remainder.
+ */
+void mp_divexact (digit_t *q, const digit_t *x, size_t xlen,
+			      const digit_t *y, size_t ylen)
+{
+	const size_t qlen = xlen - ylen + 1;
+	const digit_t inv = 0 - mp_mont_mu (y[0]);
+	digit_t d, h;
+	size_t i, n;
+
+	if (ylen == 1) {
+		mp_divexact_1 (q, x, xlen, y[0]);
+		return;
+	}
+
+	mp_copy (q, x, qlen);
+
+	for (i = 0; i < qlen; ++i) {
+		d = q[i] * inv;
+		n = qlen - i < ylen ? qlen - i : ylen;
+		h = mp_submul_1 (q + i, y, n, d, 0);
+
+		if (i + n < qlen)
+			mp_sub_1 (q + i + n, q + i + n, qlen - i - n, h);
+
+		q[i] = d;
+	}
+}
@@ -0,0 +1,168 @@
+/*
+ * MP Core Elliptic Curve Scalar Multiplication
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/bit.h>
+#include <mp/core.h>
+#include <mp/ec.h>
+#include <mp/shift.h>
+#include <mp/unit.h>
+
+#define MP_EC_WINDOW	4
+#define MP_EC_NAF	5
+
+/*
+ * Table T[i] = i P for i < 2^MP_EC_WINDOW, T[0] is the point at infinity.
+ * Complete formulas make every window cost MP_EC_WINDOW doublings and one
+ * addition, even of the point at infinity.
+ */
+void mp_ec_mul_sec (const struct mp_ec *o, digit_t *r, const digit_t *p,
+		    const digit_t *k)
+{
+	const size_t len = o->len, n = len * 3, count = 1 << MP_EC_WINDOW;
+	digit_t *T = o->ws, *s = T + count * n;
+	size_t i, j;
+
+	mp_ec_zero (o, T);
+	mp_copy (T + n, p, n);
+
+	for (i = 2; i < count; ++i)
+		if (i % 2 == 0)
+			mp_ec_dbl (o, T + i * n, T + i / 2 * n);
+		else
+			mp_ec_add (o, T + i * n, T + (i - 1) * n, T + n);
+
+	mp_ec_zero (o, r);
+
+	for (i = (o->bits + MP_EC_WINDOW - 1) / MP_EC_WINDOW; i > 0; --i) {
+		for (j = 0; j < MP_EC_WINDOW; ++j)
+			mp_ec_dbl (o, r, r);
+
+		mp_select (s, T, count, n,
+			   mp_bits (k, len, (i - 1) * MP_EC_WINDOW,
+				    MP_EC_WINDOW));
+		mp_ec_add (o, r, r, s);
+	}
+}
+
+/*
+ * Function mp_ec_naf computes width-w non-adjacent form of scalar (k, len)
+ * into (naf, len * MP_DIGIT_BITS + 1) using (t, len + 1) as a temporary,
+ * and returns the number of digits: every non-zero digit is odd, less
+ * than 2^(w - 1) by absolute value, and followed by at least w - 1 zeros.
+ */
+static size_t mp_ec_naf (signed char *naf, const digit_t *k, size_t len,
+			 int w, digit_t *t)
+{
+	const digit_t mask = ((digit_t) 1 << w) - 1, half = mask / 2 + 1;
+	digit_t d;
+	size_t i;
+
+	mp_copy (t, k, len), t[len] = 0;
+
+	for (i = 0; mp_normalize (t, len + 1) > 0; ++i) {
+		if ((t[0] & 1) == 0)
+			naf[i] = 0;
+		else if ((d = t[0] & mask) < half) {
+			naf[i] = d;
+			mp_sub_1 (t, t, len + 1, d);
+		}
+		else {
+			naf[i] = -(int) (mask + 1 - d);
+			mp_add_1 (t, t, len + 1, mask + 1 - d);
+		}
+
+		mp_rshift (t, t, len + 1, 0, 1);
+	}
+
+	return i;
+}
+
+/*
+ * Table T[j] = (2 j + 1) P for j < 2^(w - 2).
+ */
+static void mp_ec_odd (const struct mp_ec *o, digit_t *T, const digit_t *p,
+		       int w, digit_t *t)
+{
+	const size_t n = o->len * 3, count = (size_t) 1 << (w - 2);
+	size_t j;
+
+	mp_copy (T, p, n);
+	mp_ec_dbl (o, t, p);
+
+	for (j = 1; j < count; ++j)
+		mp_ec_add (o, T + j * n, T + (j - 1) * n, t);
+}
+
+/*
+ * Accumulator R with flag full: R = R + d P, or R = d P if R is empty,
+ * where P is taken from table of odd multiples T. Uses t as a temporary.
+ */
+static void mp_ec_acc (const struct mp_ec *o, digit_t *r, int *full,
+		       const digit_t *T, int d, digit_t *t)
+{
+	const size_t n = o->len * 3;
+
+	if (d > 0)
+		mp_copy (t, T + (d - 1) / 2 * n, n);
+	else
+		mp_ec_neg (o, t, T + (-d - 1) / 2 * n);
+
+	if (*full)
+		mp_ec_add (o, r, r, t);
+	else {
+		mp_copy (r, t, n);
+		*full = 1;
+	}
+}
+
+int mp_ec_mul2 (const struct mp_ec *o, digit_t *r,
+		const digit_t *u, const digit_t *p,
+		const digit_t *v, const digit_t *q)
+{
+	const size_t len = o->len, n = len * 3, count = 1 << (MP_EC_NAF - 2);
+	const size_t bits = len * MP_DIGIT_BITS + 1;
+	const size_t nlen = (bits * 2 + sizeof (digit_t) - 1) /
+			    sizeof (digit_t);
+	digit_t *P, *Q, *t;
+	signed char *nu, *nv;
+	size_t un, vn, i;
+	int full = 0;
+
+	if ((P = mp_alloc (count * n * 2 + n + nlen)) == NULL)
+		return 0;
+
+	Q  = P + count * n;
+	t  = Q + count * n;
+	nu = (void *) (t + n);
+	nv = nu + bits;
+
+	un = mp_ec_naf (nu, u, len, MP_EC_NAF, t);
+	vn = mp_ec_naf (nv, v, len, MP_EC_NAF, t);
+
+	mp_ec_odd (o, P, p, MP_EC_NAF, t);
+	mp_ec_odd (o, Q, q, MP_EC_NAF, t);
+
+	for (i = un > vn ? un : vn; i > 0; --i) {
+		if (full)
+			mp_ec_dbl (o, r, r);
+
+		if (i <= un && nu[i - 1] != 0)
+			mp_ec_acc (o, r, &full, P, nu[i - 1], t);
+
+		if (i <= vn && nv[i - 1] != 0)
+			mp_ec_acc (o, r, &full, Q, nv[i - 1], t);
+	}
+
+	if (!full)
+		mp_ec_zero (o, r);
+
+	mp_free (P);
+	return 1;
+}
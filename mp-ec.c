@@ -0,0 +1,269 @@
+/*
+ * MP Core Elliptic Curve Point Arithmetic
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/alloc.h>
+#include <mp/core.h>
+#include <mp/digit.h>
+#include <mp/ec.h>
+#include <mp/mod.h>
+#include <mp/unit.h>
+
+/*
+ * Point formulas keep the field elements reduced, as Montgomery
+ * multiplication requires, but work on the raw digits: modulus is taken
+ * from the curve once, additions and subtractions of point formulas are
+ * corrected by masked modulus, and multiplication by 3 is done with
+ * additions.
+ */
+#define MP_EC_TEMPS	11
+#define MP_EC_TABLE	16
+
+static size_t mp_ec_itch (size_t len)
+{
+	return len * MP_EC_TEMPS + (MP_EC_TABLE + 1) * len * 3;
+}
+
+int mp_ec_init (struct mp_ec *o, const digit_t *p, size_t len,
+		const digit_t *a, const digit_t *b)
+{
+	const size_t bits = len * MP_DIGIT_BITS - mp_digit_clz (p[len - 1]);
+
+	if ((o->a = mp_alloc (len * 3 + mp_ec_itch (len))) == NULL)
+		return 0;
+
+	o->b    = o->a  + len;
+	o->b3   = o->b  + len;
+	o->t    = o->b3 + len;
+	o->ws   = o->t  + len * MP_EC_TEMPS;
+	o->len  = len;
+
+	/* order of prime order curve may be one bit longer than p */
+	o->bits = bits < len * MP_DIGIT_BITS ? bits + 1 : bits;
+
+	if (!mp_mont_init (&o->p, p, len)) {
+		mp_free (o->a);
+		return 0;
+	}
+
+	mp_mont_push (&o->p, o->a, a);
+	mp_mont_push (&o->p, o->b, b);
+	mp_mod_add_n (o->b3, o->b, o->b, p, len);
+	mp_mod_add_n (o->b3, o->b3, o->b, p, len);
+	return 1;
+}
+
+void mp_ec_fini (struct mp_ec *o)
+{
+	mp_mont_fini (&o->p);
+	mp_free (o->a);
+}
+
+void mp_ec_zero (const struct mp_ec *o, digit_t *r)
+{
+	const size_t len = o->len;
+
+	mp_zero (r, len);
+	mp_copy (r + len, o->p.one, len);
+	mp_zero (r + len * 2, len);
+}
+
+void mp_ec_push (const struct mp_ec *o, digit_t *r, const digit_t *x,
+		 const digit_t *y)
+{
+	const size_t len = o->len;
+
+	mp_mont_push (&o->p, r, x);
+	mp_mont_push (&o->p, r + len, y);
+	mp_copy (r + len * 2, o->p.one, len);
+}
+
+int mp_ec_pull (const struct mp_ec *o, digit_t *x, digit_t *y,
+		const digit_t *p)
+{
+	const struct mp_mont_ctx *c = &o->p;
+	const size_t len = o->len;
+	digit_t *zi = o->t, *u = zi + len;
+
+	if (!mp_mont_inv (c, zi, p + len * 2))
+		return 0;  /* Z = 0 */
+
+	mp_mont_mul  (c, u, p, zi);
+	mp_mont_pull (c, x, u);
+	mp_mont_mul  (c, u, p + len, zi);
+	mp_mont_pull (c, y, u);
+	return 1;
+}
+
+int mp_ec_check (const struct mp_ec *o, const digit_t *x, const digit_t *y)
+{
+	const struct mp_mont_ctx *c = &o->p;
+	const size_t len = o->len;
+	digit_t *X = o->t, *Y = X + len, *u = Y + len, *v = u + len;
+	digit_t *w = v + len;
+
+	if (mp_cmp_n (x, c->m, len) >= 0 || mp_cmp_n (y, c->m, len) >= 0)
+		return 0;
+
+	mp_mont_push (c, X, x);
+	mp_mont_push (c, Y, y);
+
+	mp_mont_sqr  (c, u, Y);		/* y^2 */
+	mp_mont_sqr  (c, v, X);
+	mp_mod_add_n (v, v, o->a, c->m, len);
+	mp_mont_mul  (c, w, v, X);
+	mp_mod_add_n (w, w, o->b, c->m, len);	/* x^3 + a x + b */
+
+	return mp_cmp_n (u, w, len) == 0;
+}
+
+/*
+ * -Y = M - Y if Y is not zero, or zero otherwise, branch-free.
+ */
+void mp_ec_neg (const struct mp_ec *o, digit_t *r, const digit_t *p)
+{
+	const size_t len = o->len;
+	const digit_t *y = p + len;
+	digit_t *t = o->t, acc, mask;
+	size_t i;
+
+	for (i = 0, acc = 0; i < len; ++i)
+		acc |= y[i];
+
+	mask = 0 - ((acc | (0 - acc)) >> (MP_DIGIT_BITS - 1));
+
+	for (i = 0; i < len; ++i)
+		t[i] = o->p.m[i] & mask;
+
+	mp_sub_n (r + len, t, y, len, 0);
+
+	if (r != p) {
+		mp_copy (r, p, len);
+		mp_copy (r + len * 2, p + len * 2, len);
+	}
+}
+
+/*
+ * Algorithm 1 of Renes, Costello and Batina: 12M + 3 m_a + 2 m_3b.
+ * Montgomery multiplication result must not overlap its operands, thus
+ * products are spread over temporaries, and the sum is stored at the end.
+ */
+void mp_ec_add (const struct mp_ec *o, digit_t *r, const digit_t *p,
+		const digit_t *q)
+{
+	const struct mp_mont_ctx *c = &o->p;
+	const digit_t *m = c->m;
+	const size_t len = o->len;
+	const digit_t *X1 = p, *Y1 = X1 + len, *Z1 = Y1 + len;
+	const digit_t *X2 = q, *Y2 = X2 + len, *Z2 = Y2 + len;
+	digit_t *t0 = o->t, *t1 = t0 + len, *t2 = t1 + len, *t3 = t2 + len;
+	digit_t *t4 = t3 + len, *t5 = t4 + len, *X3 = t5 + len;
+	digit_t *Y3 = X3 + len, *Z3 = Y3 + len, *u = Z3 + len, *v = u + len;
+
+	mp_mont_mul      (c, t0, X1, X2);
+	mp_mont_mul      (c, t1, Y1, Y2);
+	mp_mont_mul      (c, t2, Z1, Z2);
+
+	mp_mod_add_n_sec (u, X1, Y1, m, len);
+	mp_mod_add_n_sec (v, X2, Y2, m, len);
+	mp_mont_mul      (c, t3, u, v);
+	mp_mod_add_n_sec (u, t0, t1, m, len);
+	mp_mod_sub_n_sec (t3, t3, u, m, len);	/* X1 Y2 + X2 Y1 */
+
+	mp_mod_add_n_sec (u, X1, Z1, m, len);
+	mp_mod_add_n_sec (v, X2, Z2, m, len);
+	mp_mont_mul      (c, t4, u, v);
+	mp_mod_add_n_sec (u, t0, t2, m, len);
+	mp_mod_sub_n_sec (t4, t4, u, m, len);	/* X1 Z2 + X2 Z1 */
+
+	mp_mod_add_n_sec (u, Y1, Z1, m, len);
+	mp_mod_add_n_sec (v, Y2, Z2, m, len);
+	mp_mont_mul      (c, t5, u, v);
+	mp_mod_add_n_sec (u, t1, t2, m, len);
+	mp_mod_sub_n_sec (t5, t5, u, m, len);	/* Y1 Z2 + Y2 Z1 */
+
+	mp_mont_mul      (c, Z3, o->a, t4);
+	mp_mont_mul      (c, X3, o->b3, t2);
+	mp_mod_add_n_sec (Z3, X3, Z3, m, len);
+	mp_mod_sub_n_sec (X3, t1, Z3, m, len);
+	mp_mod_add_n_sec (Z3, t1, Z3, m, len);
+	mp_mont_mul      (c, Y3, X3, Z3);
+
+	mp_mod_add_n_sec (t1, t0, t0, m, len);
+	mp_mod_add_n_sec (t1, t1, t0, m, len);	/* 3 X1 X2 */
+	mp_mont_mul      (c, u, o->a, t2);
+	mp_mont_mul      (c, v, o->b3, t4);
+	mp_mod_add_n_sec (t1, t1, u, m, len);
+	mp_mod_sub_n_sec (t2, t0, u, m, len);
+	mp_mont_mul      (c, t4, o->a, t2);
+	mp_mod_add_n_sec (t4, v, t4, m, len);
+
+	mp_mont_mul      (c, t0, t1, t4);
+	mp_mod_add_n_sec (Y3, Y3, t0, m, len);
+	mp_mont_mul      (c, t0, t5, t4);
+	mp_mont_mul      (c, u, t3, X3);
+	mp_mod_sub_n_sec (X3, u, t0, m, len);
+	mp_mont_mul      (c, t0, t3, t1);
+	mp_mont_mul      (c, u, t5, Z3);
+	mp_mod_add_n_sec (Z3, u, t0, m, len);
+
+	mp_copy (r, X3, len * 3);
+}
+
+/*
+ * Algorithm 3 of Renes, Costello and Batina: 8M + 3S + 3 m_a + 2 m_3b.
+ */
+void mp_ec_dbl (const struct mp_ec *o, digit_t *r, const digit_t *p)
+{
+	const struct mp_mont_ctx *c = &o->p;
+	const digit_t *m = c->m;
+	const size_t len = o->len;
+	const digit_t *X = p, *Y = X + len, *Z = Y + len;
+	digit_t *t0 = o->t, *t1 = t0 + len, *t2 = t1 + len, *t3 = t2 + len;
+	digit_t *t4 = t3 + len, *t5 = t4 + len, *X3 = t5 + len;
+	digit_t *Y3 = X3 + len, *Z3 = Y3 + len, *u = Z3 + len, *v = u + len;
+
+	mp_mont_sqr      (c, t0, X);
+	mp_mont_sqr      (c, t1, Y);
+	mp_mont_sqr      (c, t2, Z);
+	mp_mont_mul      (c, t3, X, Y);
+	mp_mod_add_n_sec (t3, t3, t3, m, len);
+	mp_mont_mul      (c, Z3, X, Z);
+	mp_mod_add_n_sec (Z3, Z3, Z3, m, len);
+
+	mp_mont_mul      (c, X3, o->a, Z3);
+	mp_mont_mul      (c, Y3, o->b3, t2);
+	mp_mod_add_n_sec (Y3, X3, Y3, m, len);
+	mp_mod_sub_n_sec (X3, t1, Y3, m, len);
+	mp_mod_add_n_sec (Y3, t1, Y3, m, len);
+	mp_mont_mul      (c, u, X3, Y3);	/* Y3 */
+	mp_mont_mul      (c, v, t3, X3);	/* X3 */
+
+	mp_mont_mul      (c, X3, o->b3, Z3);
+	mp_mont_mul      (c, t4, o->a, t2);
+	mp_mod_sub_n_sec (t3, t0, t4, m, len);
+	mp_mont_mul      (c, t5, o->a, t3);
+	mp_mod_add_n_sec (t5, t5, X3, m, len);
+
+	mp_mod_add_n_sec (Z3, t0, t0, m, len);
+	mp_mod_add_n_sec (t0, Z3, t0, m, len);	/* 3 X^2 */
+	mp_mod_add_n_sec (t0, t0, t4, m, len);
+	mp_mont_mul      (c, Y3, t0, t5);
+	mp_mod_add_n_sec (u, u, Y3, m, len);
+
+	mp_mont_mul      (c, t2, Y, Z);
+	mp_mod_add_n_sec (t2, t2, t2, m, len);
+	mp_mont_mul      (c, t0, t2, t5);
+	mp_mod_sub_n_sec (v, v, t0, m, len);
+	mp_mont_mul      (c, Z3, t2, t1);
+	mp_mod_add_n_sec (Z3, Z3, Z3, m, len);
+	mp_mod_add_n_sec (Z3, Z3, Z3, m, len);
+
+	mp_copy (r, v, len);
+	mp_copy (r + len, u, len);
+	mp_copy (r + len * 2, Z3, len);
+}
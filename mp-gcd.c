@@ -0,0 +1,831 @@
+/*
+ * MP Core Greatest Common Divisor
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <string.h>
+
+#include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/core.h>
+#include <mp/div.h>
+#include <mp/gcd.h>
+#include <mp/mul.h>
+#include <mp/pair.h>
+#include <mp/shift.h>
+#include <mp/unit.h>
+
+/*
+ * Euclidean algorithm state: remainders u >= v, and signed cofactors of
+ * x, su and sv, if extended algorithm requested. The signs of cofactors
+ * alternate, thus only magnitudes are stored, padded to common length.
+ */
+struct mp_gcd {
+	digit_t *u, *v, *t, *w;		/* remainders and scratch	*/
+	size_t un, vn;
+	digit_t *q, *su, *sv, *st, *sw;	/* cofactors and scratch or NULL */
+	size_t sn;
+	int neg;			/* su <= 0 <= sv, else sv <= 0 <= su */
+};
+
+static void mp_gcd_swap (digit_t **a, digit_t **b)
+{
+	digit_t *t = *a;
+
+	*a = *b;
+	*b = t;
+}
+
+static int mp_gcd_cmp (const digit_t *x, size_t xlen,
+		       const digit_t *y, size_t ylen)
+{
+	if (xlen != ylen)
+		return xlen < ylen ? -1 : 1;
+
+	return mp_cmp_n (x, y, xlen);
+}
+
+/*
+ * Binary algorithm for short operands
+ */
+static size_t mp_gcd_strip (digit_t *x, size_t len, size_t *bits)
+{
+	size_t i;
+	int k;
+
+	for (i = 0; x[i] == 0; ++i) {}
+
+	if (i > 0)
+		memmove (x, x + i, (len - i) * sizeof (x[0]));
+
+	len -= i;
+
+	if ((k = mp_digit_ctz (x[0])) > 0)
+		mp_rshift (x, x, len, 0, k);
+
+	*bits = i * MP_DIGIT_BITS + k;
+	return mp_normalize (x, len);
+}
+
+static size_t mp_gcd_shl (digit_t *x, size_t len, size_t bits)
+{
+	const size_t i = bits / MP_DIGIT_BITS;
+	const int k = bits % MP_DIGIT_BITS;
+
+	if (k > 0 && (x[len] = mp_lshift (x, x, len, 0, k)) != 0)
+		++len;
+
+	if (i > 0) {
+		memmove (x + i, x, len * sizeof (x[0]));
+		mp_zero (x, i);
+	}
+
+	return len + i;
+}
+
+static void mp_gcd_binary (struct mp_gcd *o)
+{
+	size_t ku, kv, k, len;
+	int cmp;
+
+	o->un = mp_gcd_strip (o->u, o->un, &ku);
+	o->vn = mp_gcd_strip (o->v, o->vn, &kv);
+
+	while ((cmp = mp_gcd_cmp (o->u, o->un, o->v, o->vn)) != 0) {
+		if (cmp < 0) {
+			mp_gcd_swap (&o->u, &o->v);
+			len = o->un, o->un = o->vn, o->vn = len;
+		}
+
+		mp_sub (o->u, o->u, o->un, o->v, o->vn, 0);
+		o->un = mp_gcd_strip (o->u, o->un, &k);
+	}
+
+	o->un = mp_gcd_shl (o->u, o->un, ku < kv ? ku : kv);
+	o->vn = 0;
+}
+
+/*
+ * Function mp_gcd_div2 divides [n1, n0] by non-zero [d1, d0], stores
+ * quotient into q, and returns zero if quotient does not fit into digit.
+ * Quotients are mostly small, thus shift-subtract method is used.
+ */
+static int mp_gcd_div2 (digit_t *q, digit_t n1, digit_t n0,
+				    digit_t d1, digit_t d0)
+{
+	digit_t r1, r0, mask;
+	int k;
+
+	if (d1 == 0) {
+		if (n1 >= d0)
+			return 0;
+
+		mp_digit_div (q, &r0, n1, n0, d0);
+		return 1;
+	}
+
+	if (n1 < d1) {
+		*q = 0;
+		return 1;
+	}
+
+	if ((k = mp_digit_clz (d1) - mp_digit_clz (n1)) > 0) {
+		d1 = d1 << k | d0 >> (MP_DIGIT_BITS - k);
+		d0 <<= k;
+	}
+
+	for (*q = 0; k >= 0; --k) {
+		mask = mp_pair_sub (&r1, &r0, n1, n0, d1, d0) - 1;  /* unpredictable */
+		n1 ^= (n1 ^ r1) & mask;
+		n0 ^= (n0 ^ r0) & mask;
+		*q = *q << 1 | (mask & 1);
+
+		d0 = d0 >> 1 | d1 << (MP_DIGIT_BITS - 1);
+		d1 >>= 1;
+	}
+
+	return 1;
+}
+
+/*
+ * Function mp_gcd_matrix runs Knuth's algorithm L on the leading digits
+ * [u1, u0] and [v1, v0] of remainders while the quotients of bounds
+ * (u + A) / (v + C) and (u + B) / (v + D) agree and cofactors fit into
+ * digit. If the exact flag set, then the leading digits are the exact
+ * remainders, and the bounds are not needed.
+ *
+ * The signed cofactors are A = a, B = -b, C = -c, D = d after even
+ * number of steps, and the opposite ones after odd number of steps.
+ */
+struct mp_gcd_matrix {
+	digit_t a, b, c, d;
+	size_t steps;
+};
+
+static void mp_gcd_matrix (struct mp_gcd_matrix *m, digit_t u1, digit_t u0,
+			   digit_t v1, digit_t v0, int exact)
+{
+	digit_t a = 1, b = 0, c = 0, d = 1, q, nc, nd;
+	digit_t n1, n0, e1, e0, h, p1, p0;
+	size_t k;
+	int odd;
+
+	for (k = 0; (v1 | v0) != 0; ++k) {
+		odd = k & 1;
+
+		if (exact) {
+			if (!mp_gcd_div2 (&q, u1, u0, v1, v0))
+				break;
+		}
+		else {
+			if (odd ? mp_pair_sub (&n1, &n0, u1, u0, 0, a) :
+				  mp_pair_add (&n1, &n0, u1, u0, 0, a))
+				break;
+
+			if (odd ? mp_pair_add (&e1, &e0, v1, v0, 0, c) :
+				  mp_pair_sub (&e1, &e0, v1, v0, 0, c))
+				break;
+
+			if ((e1 | e0) == 0 ||
+			    !mp_gcd_div2 (&q, n1, n0, e1, e0))
+				break;
+
+			if (odd ? mp_pair_add (&n1, &n0, u1, u0, 0, b) :
+				  mp_pair_sub (&n1, &n0, u1, u0, 0, b))
+				break;
+
+			if (odd ? mp_pair_sub (&e1, &e0, v1, v0, 0, d) :
+				  mp_pair_add (&e1, &e0, v1, v0, 0, d))
+				break;
+
+			/* check that 0 <= N - q E < E */
+			mp_digit_mul (&p1, &p0, q, e0);
+			mp_digit_fma (&h, &p1, q, e1, p1);
+
+			if (h != 0 || mp_pair_sub (&n1, &n0, n1, n0, p1, p0) ||
+			    !mp_pair_sub (&n1, &n0, n1, n0, e1, e0))
+				break;
+		}
+
+		mp_digit_fma (&h, &nc, q, c, a);
+
+		if (h != 0)
+			break;
+
+		mp_digit_fma (&h, &nd, q, d, b);
+
+		if (h != 0)
+			break;
+
+		mp_digit_mul (&p1, &p0, q, v0);		/* P = q v */
+		mp_digit_fma (&h, &p1, q, v1, p1);
+
+		if (h != 0 || mp_pair_sub (&n1, &n0, u1, u0, p1, p0))
+			break;
+
+		a = c, b = d, c = nc, d = nd;
+		u1 = v1, u0 = v0, v1 = n1, v0 = n0;
+	}
+
+	m->a = a, m->b = b, m->c = c, m->d = d;
+	m->steps = k;
+}
+
+/*
+ * Function mp_gcd_top extracts bits [s, s + 2w) of (x, len) into [h1, h0]
+ */
+static void mp_gcd_top (digit_t *h1, digit_t *h0,
+			const digit_t *x, size_t len, size_t s)
+{
+	const size_t i = s / MP_DIGIT_BITS;
+	const int k = s % MP_DIGIT_BITS;
+	digit_t x0 = i     < len ? x[i]     : 0;
+	digit_t x1 = i + 1 < len ? x[i + 1] : 0;
+	digit_t x2 = i + 2 < len ? x[i + 2] : 0;
+
+	if (k > 0) {
+		x0 = x0 >> k | x1 << (MP_DIGIT_BITS - k);
+		x1 = x1 >> k | x2 << (MP_DIGIT_BITS - k);
+	}
+
+	*h1 = x1;
+	*h0 = x0;
+}
+
+/*
+ * Function mp_gcd_lin_sub computes (r, len) = p x - q y, where the result
+ * is known to be non-negative and to fit into len digits, and returns its
+ * normalized length.
+ *
+ * Function mp_gcd_lin_add computes (r, len + 2) = p x + q y, and returns
+ * its normalized length.
+ */
+static size_t mp_gcd_lin_sub (digit_t *r, const digit_t *x, digit_t p,
+			      const digit_t *y, digit_t q, size_t len)
+{
+	mp_mul_1 (r, x, len, p);
+	mp_submul_1 (r, y, len, q, 0);
+	return mp_normalize (r, len);
+}
+
+static size_t mp_gcd_lin_add (digit_t *r, const digit_t *x, digit_t p,
+			      const digit_t *y, digit_t q, size_t len)
+{
+	digit_t c;
+
+	r[len] = mp_mul_1 (r, x, len, p);
+	c = mp_addmul_1 (r, y, len, q, 0);
+	r[len + 1] = mp_digit_add (r + len, r[len], c);
+	return mp_normalize (r, len + 2);
+}
+
+/*
+ * Function mp_gcd_apply applies the cofactor matrix to the remainders and
+ * to the cofactors of x:
+ *
+ *	even:	u' = a u - b v,  v' = d v - c u,
+ *	odd:	u' = b v - a u,  v' = c u - d v,
+ *
+ *	|su'| = a |su| + b |sv|,  |sv'| = c |su| + d |sv|.
+ */
+static void mp_gcd_apply (struct mp_gcd *o, const struct mp_gcd_matrix *m)
+{
+	const size_t len = o->un;
+	const int odd = m->steps & 1;
+	digit_t *u = o->u, *v = o->v;
+
+	mp_zero (v + o->vn, len - o->vn);
+
+	if (odd) {
+		o->un = mp_gcd_lin_sub (o->t, v, m->b, u, m->a, len);
+		o->vn = mp_gcd_lin_sub (o->w, u, m->c, v, m->d, len);
+	}
+	else {
+		o->un = mp_gcd_lin_sub (o->t, u, m->a, v, m->b, len);
+		o->vn = mp_gcd_lin_sub (o->w, v, m->d, u, m->c, len);
+	}
+
+	mp_gcd_swap (&o->u, &o->t);
+	mp_gcd_swap (&o->v, &o->w);
+
+	if (o->su == NULL)
+		return;
+
+	mp_gcd_lin_add (o->st, o->su, m->a, o->sv, m->b, o->sn);
+	o->sn = mp_gcd_lin_add (o->sw, o->su, m->c, o->sv, m->d, o->sn);
+
+	mp_gcd_swap (&o->su, &o->st);
+	mp_gcd_swap (&o->sv, &o->sw);
+	o->neg ^= odd;
+}
+
+/*
+ * Function mp_gcd_div does one Euclidean step: [u, v] = [v, u mod v],
+ * and updates cofactors of x: [su, sv] = [sv, su + q sv].
+ */
+static void mp_gcd_div (struct mp_gcd *o)
+{
+	digit_t *u = o->u, *v = o->v, *t = o->t, *w = o->w, *q = o->q;
+	size_t un = o->un, vn = o->vn, qn, tn, pn, n;
+	int k;
+
+	if (vn == 1) {
+		t[0] = q == NULL ? mp_mod_1 (u, un, v[0]) :
+				   mp_div_1 (q, u, un, v[0]);
+		tn = t[0] != 0;
+		qn = un;
+	}
+	else {
+		if ((k = mp_digit_clz (v[vn - 1])) > 0) {
+			t[un] = mp_lshift (t, u, un, 0, k);
+			mp_lshift (w, v, vn, 0, k);
+		}
+		else {
+			mp_copy (t, u, un);
+			mp_copy (w, v, vn);
+			t[un] = 0;
+		}
+
+		un += t[un] != 0;
+
+		if (q == NULL)
+			mp_mod (t, t, un, w, vn);
+		else
+			mp_div (q, t, t, un, w, vn);
+
+		if (k > 0)
+			mp_rshift (t, t, vn, 0, k);
+
+		tn = mp_normalize (t, vn);
+		qn = un - vn + 1;
+	}
+
+	o->u = v, o->un = o->vn;
+	o->v = t, o->vn = tn;
+	o->t = u;
+
+	if (q == NULL)
+		return;
+
+	qn = mp_normalize (q, qn);
+	pn = mp_normalize (o->sv, o->sn);
+
+	if (qn == 0 || pn == 0)
+		pn = 0;
+	else if (qn >= pn)
+		mp_mul (o->st, q, qn, o->sv, pn), pn += qn;
+	else
+		mp_mul (o->st, o->sv, pn, q, qn), pn += qn;
+
+	n = pn > o->sn ? pn : o->sn;
+
+	mp_zero (o->st + pn, n - pn);
+	mp_zero (o->su + o->sn, n - o->sn);
+	o->st[n] = mp_add_n (o->st, o->st, o->su, n, 0);
+	mp_zero (o->sv + o->sn, n + 1 - o->sn);
+	o->sn = mp_normalize (o->st, n + 1);
+
+	u = o->su, o->su = o->sv, o->sv = o->st, o->st = u;
+	o->neg ^= 1;
+}
+
+/*
+ * Function mp_gcd_lead computes single digit cofactor matrix from the
+ * leading two digits of remainders.
+ */
+static void mp_gcd_lead (struct mp_gcd_matrix *m, const struct mp_gcd *o)
+{
+	digit_t u1, u0, v1, v0;
+	size_t bits, s;
+
+	bits = o->un * MP_DIGIT_BITS - mp_digit_clz (o->u[o->un - 1]);
+	s = bits > 2 * MP_DIGIT_BITS ? bits - 2 * MP_DIGIT_BITS : 0;
+
+	mp_gcd_top (&u1, &u0, o->u, o->un, s);
+	mp_gcd_top (&v1, &v0, o->v, o->vn, s);
+	mp_gcd_matrix (m, u1, u0, v1, v0, s == 0);
+}
+
+/*
+ * Lehmer algorithm: reduce remainders by single digit cofactor matrices
+ * computed from the leading two digits, and fall back to the division
+ * step if the quotient is too large.
+ */
+static void mp_gcd_lehmer (struct mp_gcd *o)
+{
+	struct mp_gcd_matrix m;
+
+	while (o->vn > 0) {
+		mp_gcd_lead (&m, o);
+
+		if (m.steps > 0)
+			mp_gcd_apply (o, &m);
+		else
+			mp_gcd_div (o);
+	}
+}
+
+/*
+ * Half-GCD: cofactor matrix with multi-digit entries in the same signed
+ * form as above, (-1)^k [[a, -b], [-c, d]], where k is the number of
+ * quotients. Entries are padded to common length. Scratch buffers t[4]
+ * receive the entries of matrix products, and ws is a workspace for them.
+ */
+struct mp_gcd_hmat {
+	digit_t *a, *b, *c, *d, *t[4], *ws;
+	size_t len, steps;
+};
+
+static size_t mp_gcd_max (size_t a, size_t b)
+{
+	return a > b ? a : b;
+}
+
+static digit_t *mp_gcd_hmat_init (struct mp_gcd_hmat *M, size_t cap)
+{
+	digit_t *ws;
+
+	if ((ws = mp_alloc (cap * 9)) == NULL)
+		return NULL;
+
+	M->a = ws;
+	M->b = ws + cap;
+	M->c = ws + cap * 2;
+	M->d = ws + cap * 3;
+	M->t[0] = ws + cap * 4;
+	M->t[1] = ws + cap * 5;
+	M->t[2] = ws + cap * 6;
+	M->t[3] = ws + cap * 7;
+	M->ws = ws + cap * 8;
+
+	M->a[0] = 1, M->b[0] = 0, M->c[0] = 0, M->d[0] = 1;
+	M->len = 1;
+	M->steps = 0;
+	return ws;
+}
+
+/*
+ * Function mp_gcd_hmat_set pads new entries to common length and makes
+ * them current.
+ */
+static void mp_gcd_hmat_set (struct mp_gcd_hmat *M, const size_t *len,
+			     size_t steps)
+{
+	size_t n, i;
+
+	n = mp_gcd_max (mp_gcd_max (len[0], len[1]),
+			mp_gcd_max (len[2], len[3]));
+
+	for (i = 0; i < 4; ++i)
+		mp_zero (M->t[i] + len[i], n - len[i]);
+
+	mp_gcd_swap (&M->a, &M->t[0]);
+	mp_gcd_swap (&M->b, &M->t[1]);
+	mp_gcd_swap (&M->c, &M->t[2]);
+	mp_gcd_swap (&M->d, &M->t[3]);
+
+	M->len = n;
+	M->steps += steps;
+}
+
+/*
+ * Function mp_gcd_hmat_mul_1 computes M = m M for single digit matrix m
+ */
+static void mp_gcd_hmat_mul_1 (struct mp_gcd_hmat *M,
+			       const struct mp_gcd_matrix *m)
+{
+	const size_t len = M->len;
+	size_t n[4];
+
+	n[0] = mp_gcd_lin_add (M->t[0], M->a, m->a, M->c, m->b, len);
+	n[1] = mp_gcd_lin_add (M->t[1], M->b, m->a, M->d, m->b, len);
+	n[2] = mp_gcd_lin_add (M->t[2], M->a, m->c, M->c, m->d, len);
+	n[3] = mp_gcd_lin_add (M->t[3], M->b, m->c, M->d, m->d, len);
+
+	mp_gcd_hmat_set (M, n, m->steps);
+}
+
+/*
+ * Function mp_gcd_mul computes (r, xlen + ylen) = (x, xlen) (y, ylen),
+ * and returns the normalized length of product.
+ */
+static size_t mp_gcd_mul (digit_t *r, const digit_t *x, size_t xlen,
+				      const digit_t *y, size_t ylen)
+{
+	xlen = mp_normalize (x, xlen);
+	ylen = mp_normalize (y, ylen);
+
+	if (xlen == 0 || ylen == 0)
+		return 0;
+
+	if (xlen >= ylen)
+		mp_mul (r, x, xlen, y, ylen);
+	else
+		mp_mul (r, y, ylen, x, xlen);
+
+	return mp_normalize (r, xlen + ylen);
+}
+
+/*
+ * Function mp_gcd_mul_add computes r = p x + q y using workspace ws, and
+ * returns the normalized length of result. Both r and ws must have room
+ * for the longest product plus one digit.
+ *
+ * Function mp_gcd_mul_sub computes r = p x - q y in the same way, and
+ * returns zero if the result is negative.
+ */
+static size_t mp_gcd_mul_add (digit_t *r, digit_t *ws,
+			      const digit_t *p, size_t plen,
+			      const digit_t *x, size_t xlen,
+			      const digit_t *q, size_t qlen,
+			      const digit_t *y, size_t ylen)
+{
+	size_t rn = mp_gcd_mul (r,  p, plen, x, xlen);
+	size_t wn = mp_gcd_mul (ws, q, qlen, y, ylen);
+	size_t n = mp_gcd_max (rn, wn);
+
+	mp_zero (r  + rn, n - rn);
+	mp_zero (ws + wn, n - wn);
+	r[n] = mp_add_n (r, r, ws, n, 0);
+	return mp_normalize (r, n + 1);
+}
+
+static int mp_gcd_mul_sub (digit_t *r, size_t *len, digit_t *ws,
+			   const digit_t *p, size_t plen,
+			   const digit_t *x, size_t xlen,
+			   const digit_t *q, size_t qlen,
+			   const digit_t *y, size_t ylen)
+{
+	size_t rn = mp_gcd_mul (r,  p, plen, x, xlen);
+	size_t wn = mp_gcd_mul (ws, q, qlen, y, ylen);
+
+	if (mp_gcd_cmp (r, rn, ws, wn) < 0)
+		return 0;
+
+	if (wn > 0)
+		mp_sub (r, r, rn, ws, wn, 0);
+
+	*len = mp_normalize (r, rn);
+	return 1;
+}
+
+/*
+ * Function mp_gcd_hmat_mul computes M = N M
+ */
+static void mp_gcd_hmat_mul (struct mp_gcd_hmat *M,
+			     const struct mp_gcd_hmat *N)
+{
+	const size_t m = M->len, k = N->len;
+	size_t n[4];
+
+	n[0] = mp_gcd_mul_add (M->t[0], M->ws, N->a, k, M->a, m, N->b, k, M->c, m);
+	n[1] = mp_gcd_mul_add (M->t[1], M->ws, N->a, k, M->b, m, N->b, k, M->d, m);
+	n[2] = mp_gcd_mul_add (M->t[2], M->ws, N->c, k, M->a, m, N->d, k, M->c, m);
+	n[3] = mp_gcd_mul_add (M->t[3], M->ws, N->c, k, M->b, m, N->d, k, M->d, m);
+
+	mp_gcd_hmat_set (M, n, N->steps);
+}
+
+/*
+ * Function mp_gcd_reduce applies matrix M to the remainders and to the
+ * cofactors of x, as mp_gcd_apply does. Returns zero and leaves the state
+ * intact if the result is not a valid Euclidean state, u > v >= 0 (thus
+ * the matrix computed from the leading digits is not applicable), or on
+ * memory allocation failure.
+ */
+static int mp_gcd_reduce (struct mp_gcd *o, const struct mp_gcd_hmat *M)
+{
+	const size_t m = M->len, len = m + mp_gcd_max (o->un, o->sn) + 1;
+	const int odd = M->steps & 1;
+	digit_t *x, *y, *z;
+	size_t un, vn, n;
+	int ok;
+
+	if ((x = mp_alloc (len * 3)) == NULL)
+		return 0;
+
+	y = x + len;
+	z = y + len;
+
+	if (odd)
+		ok = mp_gcd_mul_sub (x, &un, z, M->b, m, o->v, o->vn,
+						M->a, m, o->u, o->un) &&
+		     mp_gcd_mul_sub (y, &vn, z, M->c, m, o->u, o->un,
+						M->d, m, o->v, o->vn);
+	else
+		ok = mp_gcd_mul_sub (x, &un, z, M->a, m, o->u, o->un,
+						M->b, m, o->v, o->vn) &&
+		     mp_gcd_mul_sub (y, &vn, z, M->d, m, o->v, o->vn,
+						M->c, m, o->u, o->un);
+
+	if (ok && (ok = mp_gcd_cmp (y, vn, x, un) < 0)) {
+		mp_copy (o->u, x, o->un = un);
+		mp_copy (o->v, y, o->vn = vn);
+	}
+
+	if (ok && o->su != NULL) {
+		un = mp_gcd_mul_add (x, z, M->a, m, o->su, o->sn,
+					   M->b, m, o->sv, o->sn);
+		vn = mp_gcd_mul_add (y, z, M->c, m, o->su, o->sn,
+					   M->d, m, o->sv, o->sn);
+		n  = mp_gcd_max (un, vn);
+
+		mp_copy (o->su, x, un);
+		mp_zero (o->su + un, n - un);
+		mp_copy (o->sv, y, vn);
+		mp_zero (o->sv + vn, n - vn);
+		o->sn = n;
+		o->neg ^= odd;
+	}
+
+	mp_free (x);
+	return ok;
+}
+
+static void mp_gcd_init (struct mp_gcd *o, digit_t *ws, size_t n,
+			 const digit_t *x, size_t xlen,
+			 const digit_t *y, size_t ylen)
+{
+	o->u = ws;
+	o->v = ws + n;
+	o->t = ws + n * 2;
+	o->w = ws + n * 3;
+
+	if (mp_gcd_cmp (x, xlen, y, ylen) < 0) {
+		const digit_t *p = x;
+		size_t len = xlen;
+
+		x = y, xlen = ylen;
+		y = p, ylen = len;
+	}
+
+	mp_copy (o->u, x, o->un = xlen);
+	mp_copy (o->v, y, o->vn = ylen);
+
+	o->q = o->su = o->sv = o->st = o->sw = NULL;
+	o->sn = 0;
+	o->neg = 0;
+}
+
+/*
+ * Function mp_gcd_hgcd_base does Lehmer steps while both remainders have
+ * more than s + 1 digits, and accumulates the matrices into M.
+ *
+ * Function mp_gcd_hgcd_top computes the half-GCD matrix for the leading
+ * digits of remainders starting from digit p, applies it to the state,
+ * and accumulates it into M, if M is not NULL. Returns zero if no
+ * progress was made.
+ *
+ * Function mp_gcd_hgcd reduces remainders of length n to about n / 2
+ * digits recursively: the first half-GCD of the leading n / 2 digits
+ * reduces them to about 3n / 4 digits, the second one to about n / 2.
+ * Remainders stay above B^s, where s = n / 2 + 1, thus the resulting
+ * matrix is valid for any numbers with the same leading digits unless
+ * a large quotient follows, which is caught by mp_gcd_reduce.
+ */
+static void mp_gcd_hgcd_base (struct mp_gcd_hmat *M, struct mp_gcd *o,
+			      size_t s)
+{
+	struct mp_gcd_matrix m;
+
+	while (o->vn > s + 1) {
+		mp_gcd_lead (&m, o);
+
+		if (m.steps == 0)
+			break;
+
+		mp_gcd_apply (o, &m);
+		mp_gcd_hmat_mul_1 (M, &m);
+	}
+}
+
+static int mp_gcd_hgcd (struct mp_gcd_hmat *M, struct mp_gcd *o);
+
+static int mp_gcd_hgcd_top (struct mp_gcd_hmat *M, struct mp_gcd *o,
+			    size_t p)
+{
+	const size_t n = o->un - p, cap = n + 2;
+	struct mp_gcd_hmat N;
+	struct mp_gcd h;
+	digit_t *ws, *ms;
+	int ok = 0;
+
+	if (o->vn <= p + 1 || (ws = mp_alloc (cap * 4)) == NULL)
+		return 0;
+
+	if ((ms = mp_gcd_hmat_init (&N, cap)) == NULL)
+		goto no_hmat;
+
+	mp_gcd_init (&h, ws, cap, o->u + p, n, o->v + p, o->vn - p);
+
+	if ((ok = mp_gcd_hgcd (&N, &h) && mp_gcd_reduce (o, &N)) && M != NULL)
+		mp_gcd_hmat_mul (M, &N);
+
+	mp_free (ms);
+no_hmat:
+	mp_free (ws);
+	return ok;
+}
+
+static int mp_gcd_hgcd (struct mp_gcd_hmat *M, struct mp_gcd *o)
+{
+	const size_t s = o->un / 2 + 1;
+
+	if (o->un >= MP_GCD_HGCD_CUTOFF &&
+	    mp_gcd_hgcd_top (M, o, o->un / 2) && o->vn > s + 1)
+		mp_gcd_hgcd_top (M, o, s * 2 - o->un);
+
+	mp_gcd_hgcd_base (M, o, s);
+	return M->steps > 0;
+}
+
+/*
+ * Euclidean algorithm: reduce large remainders by half-GCD matrices of
+ * their leading halves, or do the division step if that fails, and
+ * finish with Lehmer algorithm.
+ */
+static void mp_gcd_run (struct mp_gcd *o)
+{
+	while (o->vn > 0 && o->un >= MP_GCD_DC_CUTOFF)
+		if (!mp_gcd_hgcd_top (NULL, o, o->un / 2))
+			mp_gcd_div (o);
+
+	mp_gcd_lehmer (o);
+}
+
+size_t mp_gcd (digit_t *g, const digit_t *x, size_t xlen,
+			   const digit_t *y, size_t ylen)
+{
+	const size_t n = (xlen > ylen ? xlen : ylen) + 2;
+	struct mp_gcd o;
+	digit_t *ws;
+
+	xlen = mp_normalize (x, xlen);
+	ylen = mp_normalize (y, ylen);
+
+	if (xlen == 0 || ylen == 0) {
+		if (xlen == 0)
+			x = y, xlen = ylen;
+
+		mp_copy (g, x, xlen);
+		return xlen;
+	}
+
+	if ((ws = mp_alloc (n * 4)) == NULL)
+		return 0;
+
+	mp_gcd_init (&o, ws, n, x, xlen, y, ylen);
+
+	if (o.un < MP_GCD_LEHMER_CUTOFF)
+		mp_gcd_binary (&o);
+	else
+		mp_gcd_run (&o);
+
+	mp_copy (g, o.u, o.un);
+	mp_free (ws);
+	return o.un;
+}
+
+size_t mp_gcdext (digit_t *g, digit_t *s, const digit_t *x, size_t xlen,
+					  const digit_t *y, size_t ylen)
+{
+	const size_t n = (xlen > ylen ? xlen : ylen) + 2, slen = ylen;
+	struct mp_gcd o;
+	digit_t *ws;
+	int swap;
+
+	xlen = mp_normalize (x, xlen);
+	ylen = mp_normalize (y, ylen);
+
+	if ((ws = mp_alloc (n * 9)) == NULL)
+		return 0;
+
+	swap = mp_gcd_cmp (x, xlen, y, ylen) < 0;
+	mp_gcd_init (&o, ws, n, x, xlen, y, ylen);
+
+	o.q  = ws + n * 4;
+	o.su = ws + n * 5;
+	o.sv = ws + n * 6;
+	o.st = ws + n * 7;
+	o.sw = ws + n * 8;
+
+	o.su[0] = !swap;	/* formal step with zero quotient if x < y */
+	o.sv[0] = swap;
+	o.sn  = 1;
+	o.neg = swap;
+
+	mp_gcd_run (&o);
+
+	/* S = su if su > 0, or S = Y / G - |su| otherwise */
+	if (o.neg || mp_normalize (o.su, o.sn) == 0)
+		mp_sub_n (o.su, o.sv, o.su, o.sn, 0);
+
+	mp_copy (g, o.u, o.un);
+	mp_copy (s, o.su, o.sn);
+	mp_zero (s + o.sn, slen - o.sn);
+	mp_free (ws);
+	return o.un;
+}
@@ -0,0 +1,37 @@
+/*
+ * MP Core Modulo by Single Digit with Precomputed Inverse
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/digit.h>
+#include <mp/div.h>
+#include <mp/pair.h>
+
+digit_t mp_mod_1_pi (const digit_t *x, size_t len, digit_t y, digit_t v)
+{
+	const int s = mp_digit_clz (y), t = MP_DIGIT_BITS - s;
+	const digit_t d = y << s;
+	digit_t q, rem, n;
+	size_t i;
+
+	if (len == 0)
+		return 0;
+
+	if (s == 0) {
+		for (i = len, rem = 0; i > 0; --i)
+			mp_pair_div_pi (&q, &rem, rem, x[i - 1], d, v);
+
+		return rem;
+	}
+
+	for (i = len - 1, rem = x[i] >> t; i > 0; --i) {
+		n = (x[i] << s) | (x[i - 1] >> t);
+		mp_pair_div_pi (&q, &rem, rem, n, d, v);
+	}
+
+	mp_pair_div_pi (&q, &rem, rem, x[0] << s, d, v);
+	return rem >> s;
+}
@@ -0,0 +1,131 @@
+/*
+ * MP Core Modulo by Single Digit with Folding
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/div.h>
+#include <mp/pair.h>
+
+#define MP_MOD_1S_BLOCK	8	/* divisors processed together in batch */
+
+void mp_mod_1s_init (digit_t *c, digit_t y)
+{
+	const digit_t b[4] = {0, 0, 0, 1};
+
+	c[0] = mp_div_1_inv (y);
+	c[1] = mp_digit_clz (y);
+	c[2] = mp_mod_1_pi (b + 2, 2, y, c[0]);  /* B   mod y */
+	c[3] = mp_mod_1_pi (b + 1, 3, y, c[0]);  /* B^2 mod y */
+	c[4] = mp_mod_1_pi (b + 0, 4, y, c[0]);  /* B^3 mod y */
+}
+
+/*
+ * Folds two digits into accumulator: [rh, rl] = rh b3 + rl b2 + x1 b1 + x0,
+ * where bi = B^i mod y. The sum is less than (B - 1) y + 2 B y + B, thus
+ * it fits into two digits for y <= B / 4.
+ */
+static inline void mp_mod_1s_fold (digit_t *rh, digit_t *rl,
+				   digit_t x1, digit_t x0, const digit_t *c)
+{
+	digit_t h, l, ph, pl;
+
+	mp_digit_fma (&h, &l, x1, c[2], x0);
+
+	mp_digit_mul (&ph, &pl, *rl, c[3]);
+	mp_pair_add (&h, &l, h, l, ph, pl);
+
+	mp_digit_mul (&ph, &pl, *rh, c[4]);
+	mp_pair_add (rh, rl, h, l, ph, pl);
+}
+
+/*
+ * Reduces [h, l] modulo y: first h, then the pair, both normalized by
+ * shift s as in mp_mod_1_pi.
+ */
+static digit_t mp_mod_1s_reduce (digit_t h, digit_t l, digit_t y,
+				 const digit_t *c)
+{
+	const int s = c[1], t = MP_DIGIT_BITS - s;
+	const digit_t d = y << s;
+	digit_t q, r;
+
+	if (s == 0) {
+		mp_pair_div_pi (&q, &r, 0, h, d, c[0]);
+		mp_pair_div_pi (&q, &r, r, l, d, c[0]);
+		return r;
+	}
+
+	mp_pair_div_pi (&q, &r, h >> t, h << s, d, c[0]);
+	mp_pair_div_pi (&q, &r, r | (l >> t), l << s, d, c[0]);
+	return r >> s;
+}
+
+digit_t mp_mod_1s (const digit_t *x, size_t len, digit_t y, const digit_t *c)
+{
+	digit_t rh, rl;
+	size_t i = len - len % 2;
+
+	if (len < 2)
+		return mp_mod_1_pi (x, len, y, c[0]);
+
+	if (i < len)
+		rh = 0, rl = x[i];
+	else
+		rh = x[i - 1], rl = x[i - 2], i -= 2;
+
+	while (i > 0) {
+		i -= 2;
+		mp_mod_1s_fold (&rh, &rl, x[i + 1], x[i], c);
+	}
+
+	return mp_mod_1s_reduce (rh, rl, y, c);
+}
+
+/*
+ * The divisors are processed in blocks, every block is a single pass over
+ * X with independent accumulators, thus folds of different divisors are
+ * executed in parallel.
+ */
+void mp_mod_1s_batch (digit_t *r, const digit_t *x, size_t len,
+		      const digit_t *y, const digit_t *c, size_t count)
+{
+	digit_t rh[MP_MOD_1S_BLOCK], rl[MP_MOD_1S_BLOCK];
+	const size_t top = len - len % 2;
+	size_t i, j, n;
+
+	if (len < 2) {
+		for (j = 0; j < count; ++j)
+			r[j] = mp_mod_1_pi (x, len, y[j], c[j * MP_MOD_1S_SIZE]);
+
+		return;
+	}
+
+	for (; count > 0; r += n, y += n, c += n * MP_MOD_1S_SIZE, count -= n) {
+		n = count < MP_MOD_1S_BLOCK ? count : MP_MOD_1S_BLOCK;
+		i = top;
+
+		for (j = 0; j < n; ++j)
+			if (i < len)
+				rh[j] = 0, rl[j] = x[i];
+			else
+				rh[j] = x[i - 1], rl[j] = x[i - 2];
+
+		if (i == len)
+			i -= 2;
+
+		while (i > 0) {
+			i -= 2;
+
+			for (j = 0; j < n; ++j)
+				mp_mod_1s_fold (rh + j, rl + j, x[i + 1], x[i],
+						c + j * MP_MOD_1S_SIZE);
+		}
+
+		for (j = 0; j < n; ++j)
+			r[j] = mp_mod_1s_reduce (rh[j], rl[j], y[j],
+						 c + j * MP_MOD_1S_SIZE);
+	}
+}
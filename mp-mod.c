@@ -7,6 +7,7 @@
  */
 
 #include <mp/add.h>
+#include <mp/alloc.h>
 #include <mp/div.h>
 #include <mp/pair.h>
 #include <mp/mul.h>
@@ -30,7 +31,8 @@ digit_t mp_mod_reduce (digit_t c, digit_t *r, const digit_t *d, size_t dlen,
  * Function mp_mod divides (n, nlen) by (d, dlen), stores remainder into
  * (r, nlen), and returns the size of remainder. Constraints: n and d are
  * normalized, the most significant bit of d is set, and nlen >= dlen > 0.
- * Note that the remainder is not normalized.
+ * Note that the remainder is not normalized. For large divisors and
+ * quotinents it falls back to mp_div, which uses recursive division.
  *
  * Tip: Normalize n and d, and then shift n and d left by clz(d) before
  * calling the mp_div function.
@@ -38,9 +40,16 @@ digit_t mp_mod_reduce (digit_t c, digit_t *r, const digit_t *d, size_t dlen,
 size_t mp_mod (digit_t *r, const digit_t *n, size_t nlen,
 			   const digit_t *d, size_t dlen)
 {
-	digit_t c = 0, inv;
+	digit_t c = 0, inv, *q;
 	size_t i, j;
 
+	if (dlen >= MP_DIV_DC_CUTOFF && nlen - dlen >= MP_DIV_DC_CUTOFF &&
+	    (q = mp_alloc (nlen - dlen + 1)) != NULL) {
+		i = mp_div (q, r, n, nlen, d, dlen);  /* recursive division */
+		mp_free (q);
+		return i;
+	}
+
 	if (r != n)
 		mp_copy (r, n, nlen);
 
@@ -0,0 +1,138 @@
+/*
+ * MP Core Fixed-Base Modular Exponentiation in Montgomery Form
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/alloc.h>
+#include <mp/bit.h>
+#include <mp/mont-mul.h>
+#include <mp/unit.h>
+
+/*
+ * Lim-Lee comb with h teeth spaced by d = ceil (bits / h) bits: exponent
+ * is cut into h rows of d bits, column i of the comb selects the table
+ * entry T[k] = G[0]^k0 ... G[h-1]^k(h-1), where G[j] = X^(2^(j d)) and kj
+ * is the bit i + j d of exponent. Evaluation takes d squarings and d
+ * multiplications.
+ */
+int mp_mont_comb_init (struct mp_mont_comb *o, const struct mp_mont_ctx *c,
+		       const digit_t *x, size_t bits, size_t h)
+{
+	const size_t len = c->len;
+	digit_t *G, *t;
+	size_t n, i, j, k;
+
+	if (h == 0 || h >= MP_DIGIT_BITS || bits > len * MP_DIGIT_BITS)
+		return 0;
+
+	n = (size_t) 1 << h;
+
+	if (n + 2 > SIZE_MAX / sizeof (digit_t) / len ||
+	    (o->T = mp_alloc ((n + 2) * len)) == NULL)
+		return 0;
+
+	o->t    = o->T + n * len;
+	o->c    = c;
+	o->bits = bits;
+	o->h    = h;
+	o->d    = (bits + h - 1) / h;
+
+	G = o->t;  /* G[j] in turn */
+	t = G + len;
+
+	mp_copy (o->T, c->one, len);
+	mp_copy (G, x, len);
+
+	for (j = 0; j < h; ++j) {
+		if (j > 0)
+			for (i = 0; i < o->d; ++i) {
+				mp_mont_sqr (c, t, G);
+				mp_copy (G, t, len);
+			}
+
+		for (k = 0; k < ((size_t) 1 << j); ++k)
+			mp_mont_mul (c, o->T + (k + ((size_t) 1 << j)) * len,
+				     o->T + k * len, G);
+	}
+
+	return 1;
+}
+
+void mp_mont_comb_fini (struct mp_mont_comb *o)
+{
+	mp_free (o->T);
+}
+
+/*
+ * Returns the comb column i of exponent (y, len), positions are public.
+ */
+static size_t mp_mont_comb_column (const struct mp_mont_comb *o,
+				   const digit_t *y, size_t i)
+{
+	size_t k, j, p;
+
+	for (k = 0, j = o->h; j > 0; --j) {
+		p = i + (j - 1) * o->d;
+		k = (k << 1) | (p < o->bits && mp_bit (y, p));
+	}
+
+	return k;
+}
+
+void mp_mont_comb_pow (const struct mp_mont_comb *o, digit_t *r,
+		       const digit_t *y)
+{
+	const struct mp_mont_ctx *c = o->c;
+	const size_t len = c->len;
+	size_t i, k;
+	int full = 0;
+
+	for (i = o->d; i > 0; --i) {
+		if (full) {
+			mp_mont_sqr (c, o->t, r);
+			mp_copy (r, o->t, len);
+		}
+
+		if ((k = mp_mont_comb_column (o, y, i - 1)) == 0)
+			continue;
+
+		if (full) {
+			mp_mont_mul (c, o->t, r, o->T + k * len);
+			mp_copy (r, o->t, len);
+		}
+		else {
+			mp_copy (r, o->T + k * len, len);
+			full = 1;
+		}
+	}
+
+	if (!full)
+		mp_copy (r, c->one, len);
+}
+
+/*
+ * Every column costs one squaring, one full masked scan of the table and
+ * one multiplication, even by one, thus the sequence of operations and
+ * memory accesses does not depend on exponent.
+ */
+void mp_mont_comb_pow_sec (const struct mp_mont_comb *o, digit_t *r,
+			   const digit_t *y)
+{
+	const struct mp_mont_ctx *c = o->c;
+	const size_t len = c->len, n = (size_t) 1 << o->h;
+	digit_t *t = o->t, *s = t + len;
+	size_t i, k;
+
+	mp_copy (r, c->one, len);
+
+	for (i = o->d; i > 0; --i) {
+		k = mp_mont_comb_column (o, y, i - 1);
+
+		mp_mont_sqr (c, t, r);
+		mp_select (s, o->T, n, len, k);
+		mp_mont_mul (c, r, t, s);
+	}
+}
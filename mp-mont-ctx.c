@@ -0,0 +1,37 @@
+/*
+ * MP Core Modular Arithmetics: Montgomery Context
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/alloc.h>
+#include <mp/mont-mul.h>
+#include <mp/unit.h>
+
+int mp_mont_init (struct mp_mont_ctx *o, const digit_t *m, size_t len)
+{
+	const size_t pow_itch = mp_mont_pow_itch (len);
+	const size_t inv_itch = mp_mont_inv_itch (len);
+	const size_t itch = pow_itch > inv_itch ? pow_itch : inv_itch;
+
+	if ((o->m = mp_alloc (len * 3 + itch)) == NULL)
+		return 0;
+
+	o->ro  = o->m  + len;
+	o->one = o->ro + len;
+	o->ws  = o->one + len;
+	o->len = len;
+	o->mu  = mp_mont_mu (m[0]);
+
+	mp_copy (o->m, m, len);
+	mp_mont_ro_gen_ws (o->ro, m, len, o->ws);
+	mp_mont_pull_n (o->one, o->ro, m, len, o->mu);
+	return 1;
+}
+
+void mp_mont_fini (struct mp_mont_ctx *o)
+{
+	mp_free (o->m);
+}
@@ -0,0 +1,44 @@
+/*
+ * MP Core Batch Modular Inversion in Montgomery Form
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/mont-mul.h>
+#include <mp/unit.h>
+
+/*
+ * Montgomery trick: R[i] = X[0] ... X[i] are prefix products, A = R[n-1]^-1,
+ * then for i from n - 1 down to 1, R[i] = A R[i-1] and A = A X[i], finally
+ * R[0] = A. The cost is one inversion and 3 (n - 1) multiplications.
+ */
+int mp_mont_inv_batch (digit_t *r, const digit_t *x, size_t count,
+		       const digit_t *ro, const digit_t *m, size_t len,
+		       digit_t mu, digit_t *ws)
+{
+	digit_t *a = ws, *t = a + len;
+	size_t i;
+	int ok;
+
+	if (count == 0)
+		return 1;
+
+	mp_copy (r, x, len);
+
+	for (i = 1; i < count; ++i)
+		mp_mont_mul_n (r + i * len, r + (i - 1) * len, x + i * len,
+			       m, len, mu);
+
+	ok = mp_mont_inv_n_ws (a, r + (count - 1) * len, ro, m, len, mu, t);
+
+	for (i = count - 1; i > 0; --i) {
+		mp_mont_mul_n (r + i * len, a, r + (i - 1) * len, m, len, mu);
+		mp_mont_mul_n (t, a, x + i * len, m, len, mu);
+		mp_copy (a, t, len);
+	}
+
+	mp_copy (r, a, len);
+	return ok;
+}
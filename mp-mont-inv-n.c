@@ -0,0 +1,238 @@
+/*
+ * MP Core Modular Inversion in Montgomery Form, Secure Variant
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/mont-mul.h>
+#include <mp/pair.h>
+#include <mp/unit.h>
+
+/*
+ * Bernstein-Yang constant-time inversion: divsteps on (delta, f, g) with
+ * f = M, g = X, and cofactors d, e, such that d X = f C, e X = g C modulo
+ * M, where C = ro. Divsteps are batched by MP_INV_STEPS: transition matrix
+ * is computed from the low digits of f and g, then it is applied to the
+ * full numbers. Numbers f, g, d and e are signed, stored in two's
+ * complement in len + 1 digits.
+ */
+#define MP_INV_STEPS	(MP_DIGIT_BITS - 2)
+
+static digit_t mp_inv_mask (digit_t x)  /* ~0 if x is negative */
+{
+	return 0 - (x >> (MP_DIGIT_BITS - 1));
+}
+
+/*
+ * Transition matrix [[u, v], [q, r]] scaled by 2^MP_INV_STEPS, such that
+ * updated f = (u f + v g) / 2^MP_INV_STEPS, g = (q f + r g) / 2^MP_INV_STEPS.
+ * Entries are signed.
+ */
+struct mp_inv_matrix {
+	digit_t u, v, q, r;
+};
+
+/*
+ * Function mp_inv_divsteps does MP_INV_STEPS divsteps on the low digits
+ * of f and g, and returns the new delta. Branch-free: every step swaps
+ * rows (negating g) if delta > 0 and g is odd, adds f to g if g is odd,
+ * and halves g by doubling the f row of matrix.
+ */
+static digit_t mp_inv_divsteps (struct mp_inv_matrix *t, digit_t delta,
+				digit_t f, digit_t g)
+{
+	digit_t u = 1, v = 0, q = 0, r = 1, odd, swap, x;
+	int i;
+
+	for (i = 0; i < MP_INV_STEPS; ++i) {
+		odd  = 0 - (g & 1);
+		swap = mp_inv_mask (0 - delta) & odd;
+
+		x = (f ^ g) & swap, f ^= x, g ^= x, g = (g ^ swap) - swap;
+		x = (u ^ q) & swap, u ^= x, q ^= x, q = (q ^ swap) - swap;
+		x = (v ^ r) & swap, v ^= x, r ^= x, r = (r ^ swap) - swap;
+
+		delta = (delta ^ swap) - swap;
+
+		g += f & odd, q += u & odd, r += v & odd;
+		g >>= 1, u <<= 1, v <<= 1, ++delta;
+	}
+
+	t->u = u, t->v = v, t->q = q, t->r = r;
+	return delta;
+}
+
+/*
+ * Function mp_inv_mul computes signed product (h, l) = x y, where y is
+ * signed and x is signed if sx is ~0, or unsigned if sx is zero.
+ */
+static void mp_inv_mul (digit_t *h, digit_t *l, digit_t x, digit_t sx,
+			digit_t y)
+{
+	mp_digit_mul (h, l, x, y);
+	*h -= (x & mp_inv_mask (y)) + (y & sx & mp_inv_mask (x));
+}
+
+/*
+ * Function mp_inv_lin computes (r, len) = (u X + v Y + w M) / 2^MP_INV_STEPS
+ * for signed numbers X = (x, len), Y = (y, len) and non-negative M = (m,
+ * len), if m is not NULL. Constraint: the division is exact and result
+ * fits into len digits.
+ */
+static void mp_inv_lin (digit_t *r, const digit_t *x, digit_t u,
+			const digit_t *y, digit_t v,
+			const digit_t *m, digit_t w, size_t len)
+{
+	digit_t ah = 0, al = 0, h, l, sx = 0, prev = 0;
+	size_t i;
+
+	for (i = 0; i < len; ++i) {
+		if (i + 1 == len)
+			sx = ~(digit_t) 0;  /* top digits are signed */
+
+		mp_inv_mul (&h, &l, x[i], sx, u);
+		mp_pair_add (&ah, &al, ah, al, h, l);
+		mp_inv_mul (&h, &l, y[i], sx, v);
+		mp_pair_add (&ah, &al, ah, al, h, l);
+
+		if (m != NULL) {
+			mp_inv_mul (&h, &l, m[i], sx, w);
+			mp_pair_add (&ah, &al, ah, al, h, l);
+		}
+
+		if (i > 0)
+			r[i - 1] = (prev >> MP_INV_STEPS) |
+				   (al << (MP_DIGIT_BITS - MP_INV_STEPS));
+
+		prev = al;
+		al = ah, ah = mp_inv_mask (ah);
+	}
+
+	r[len - 1] = (prev >> MP_INV_STEPS) |
+		     (al << (MP_DIGIT_BITS - MP_INV_STEPS));
+}
+
+/*
+ * Function mp_inv_norm brings signed D in range (-M, 2M) into [0, M)
+ * using t as temporary: adds M if D is negative, then subtracts M if
+ * the result is not less than M.
+ */
+static void mp_inv_norm (digit_t *d, const digit_t *m, digit_t *t,
+			 size_t len)
+{
+	digit_t mask = mp_inv_mask (d[len - 1]);
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+		t[i] = m[i] & mask;
+
+	mp_add_n (d, d, t, len, 0);
+	mp_sub_n (t, d, m, len, 0);
+
+	mask = mp_inv_mask (t[len - 1]);
+
+	for (i = 0; i < len; ++i)
+		d[i] = (d[i] & mask) | (t[i] & ~mask);
+}
+
+/*
+ * Function mp_inv_update applies transition matrix t to cofactors d and e
+ * modulo M, keeping them in range [0, M). Multiple of M is added to each
+ * combination to make it divisible by 2^MP_INV_STEPS, where mu = -M^-1
+ * mod B.
+ */
+static void mp_inv_update (digit_t *d, digit_t *e, digit_t *nd, digit_t *ne,
+			   const struct mp_inv_matrix *t,
+			   const digit_t *m, size_t len, digit_t mu)
+{
+	const digit_t mask = ((digit_t) 1 << MP_INV_STEPS) - 1;
+	digit_t md = ((t->u * d[0] + t->v * e[0]) * mu) & mask;
+	digit_t me = ((t->q * d[0] + t->r * e[0]) * mu) & mask;
+
+	mp_inv_lin (nd, d, t->u, e, t->v, m, md, len);
+	mp_inv_lin (ne, d, t->q, e, t->r, m, me, len);
+
+	mp_inv_norm (nd, m, d, len);
+	mp_inv_norm (ne, m, d, len);
+
+	mp_copy (d, nd, len);
+	mp_copy (e, ne, len);
+}
+
+/*
+ * The number of divsteps required for numbers of d bits, by theorem 11.2
+ * of Bernstein and Yang, "Fast constant-time gcd computation and modular
+ * inversion".
+ */
+static size_t mp_inv_bound (size_t d)
+{
+	return d < 46 ? (49 * d + 80) / 17 : (49 * d + 57) / 17;
+}
+
+int mp_mont_inv_n_ws (digit_t *r, const digit_t *x, const digit_t *ro,
+		      const digit_t *m, size_t len, digit_t mu, digit_t *ws)
+{
+	const size_t n = len + 1, bits = len * MP_DIGIT_BITS;
+	const size_t count = (mp_inv_bound (bits) + MP_INV_STEPS - 1) /
+			     MP_INV_STEPS;
+	digit_t *f = ws, *g = f + n, *d = g + n, *e = d + n, *M = e + n;
+	digit_t *nf = M + n, *ng = nf + n, delta = 1, sign, acc;
+	struct mp_inv_matrix t;
+	size_t i;
+
+	mp_copy (M, m, len), M[len] = 0;
+	mp_copy (f, m, len), f[len] = 0;
+	mp_copy (g, x, len), g[len] = 0;
+	mp_zero (d, n);
+	mp_copy (e, ro, len), e[len] = 0;
+
+	for (i = 0; i < count; ++i) {
+		delta = mp_inv_divsteps (&t, delta, f[0], g[0]);
+
+		mp_inv_lin (nf, f, t.u, g, t.v, NULL, 0, n);
+		mp_inv_lin (ng, f, t.q, g, t.r, NULL, 0, n);
+		mp_copy (f, nf, n);
+		mp_copy (g, ng, n);
+
+		mp_inv_update (d, e, nf, ng, &t, M, n, mu);
+	}
+
+	/* now g = 0 and f = ±gcd (M, X), thus R = sign (f) d */
+	sign = mp_inv_mask (f[len]);
+
+	for (i = 0; i < n; ++i)
+		f[i] ^= sign, d[i] ^= sign;
+
+	mp_add_1 (f, f, n, sign & 1);
+	mp_add_1 (d, d, n, sign & 1);
+	mp_inv_norm (d, M, e, n);
+	mp_copy (r, d, len);
+
+	for (i = 1, acc = f[0] ^ 1; i < n; ++i)
+		acc |= f[i];
+
+	return (int) (((acc | (0 - acc)) >> (MP_DIGIT_BITS - 1)) ^ 1);
+}
+
+int mp_mont_inv_n (digit_t *r, const digit_t *x, const digit_t *ro,
+		   const digit_t *m, size_t len, digit_t mu)
+{
+	digit_t *ws;
+	int ok;
+
+	if ((ws = mp_alloc (mp_mont_inv_itch (len))) == NULL)
+		return 0;
+
+	ok = mp_mont_inv_n_ws (r, x, ro, m, len, mu, ws);
+	mp_free (ws);
+	return ok;
+}
+
+int mp_mont_inv (const struct mp_mont_ctx *o, digit_t *r, const digit_t *x)
+{
+	return mp_mont_inv_n_ws (r, x, o->ro, o->m, o->len, o->mu, o->ws);
+}
@@ -8,24 +8,17 @@
 
 #include <mp/mont-mul.h>
 
-static inline digit_t mp_digit_mod_exp2 (digit_t x, int n)
-{
-	const digit_t mask = ((digit_t) 1 << n) - 1;
-
-	return x & mask;
-}
-
+/*
+ * For odd m0 the initial approximation x = m0 is valid modulo 2^3, and
+ * every Newton step x = x (2 - m0 x) doubles the number of valid bits.
+ */
 digit_t mp_mont_mu (digit_t m0)
 {
 	digit_t x;
 	int i;
 
-	for (x = 1, i = 2; i < MP_DIGIT_BITS; ++i)
-		if (mp_digit_mod_exp2 (m0 * x, i) != 1)
-			x |= (digit_t) 1 << (i - 1);
-
-	if ((digit_t) (m0 * x) != 1)
-		x |= (digit_t) 1 << (i - 1);
+	for (x = m0, i = 3; i < MP_DIGIT_BITS; i *= 2)
+		x *= 2 - m0 * x;
 
 	return 0 - x;
 }
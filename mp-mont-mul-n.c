@@ -7,27 +7,73 @@
  */
 
 #include <mp/digit.h>
+#include <mp/mod.h>
+#include <mp/mont-fixed.h>
 #include <mp/mont-mul.h>
-#include <mp/mul.h>
-#include <mp/shift.h>
+#include <mp/unit.h>
 
+/*
+ * Fixed-size kernels for P-256, P-384, P-521, RSA-2048 and RSA-4096: small
+ * ones are straight-line code, large ones keep the outer loop.
+ */
+MP_MONT_MUL_FIXED (mp_mont_mul_256,  256,  1)
+MP_MONT_MUL_FIXED (mp_mont_mul_384,  384,  1)
+MP_MONT_MUL_FIXED (mp_mont_mul_521,  521,  1)
+MP_MONT_MUL_FIXED (mp_mont_mul_2048, 2048, 0)
+MP_MONT_MUL_FIXED (mp_mont_mul_4096, 4096, 0)
+
+/*
+ * Coarsely integrated operand scanning (CIOS) with fused inner loop: every
+ * outer step adds X * y[i] and M * q in one pass over digits, keeping both
+ * carry chains in registers and storing the sum shifted down by one digit,
+ * thus R is read and written only once per outer step. The invariant is
+ * T < 2M, therefore the top carry c never exceeds one, and one masked
+ * subtraction of M completes the reduction.
+ */
 void mp_mont_mul_n (digit_t *r, const digit_t *x, const digit_t *y,
 		    const digit_t *m, size_t len, digit_t mu)
 {
-	digit_t h;
-	char c;
-	size_t i;
-
-	h = mp_mul_1 (r, x, len, y[0]);
-	c = mp_digit_add (&h, h, mp_addmul_1 (r, m, len, mu * r[0], 0));
-	mp_rshift_word (r, r, len, h);
-
-	for (i = 1; i < len; ++i) {
-		h = mp_addmul_1 (r, x, len, y[i], 0) + c;
-		c = mp_digit_add (&h, h, mp_addmul_1 (r, m, len, mu * r[0], 0));
-		mp_rshift_word (r, r, len, h);
+	digit_t yi, q, h, l, h1, h2;
+	char c = 0;
+	size_t i, j;
+
+	switch (len) {
+	case MP_MONT_DIGITS (256):
+		mp_mont_mul_256  (r, x, y, m, mu);
+		return;
+	case MP_MONT_DIGITS (384):
+		mp_mont_mul_384  (r, x, y, m, mu);
+		return;
+	case MP_MONT_DIGITS (521):
+		mp_mont_mul_521  (r, x, y, m, mu);
+		return;
+	case MP_MONT_DIGITS (2048):
+		mp_mont_mul_2048 (r, x, y, m, mu);
+		return;
+	case MP_MONT_DIGITS (4096):
+		mp_mont_mul_4096 (r, x, y, m, mu);
+		return;
+	}
+
+	mp_zero (r, len);
+
+	for (i = 0; i < len; ++i) {
+		yi = y[i];
+
+		mp_digit_fma (&h1, &l, x[0], yi, r[0]);
+		q = l * mu;
+		mp_digit_fma (&h2, &l, m[0], q, l);  /* l = 0 here */
+
+		for (j = 1; j < len; ++j) {
+			mp_digit_fma (&h, &l, x[j], yi, r[j]);
+			h1 = h + mp_digit_add (&l, l, h1);
+
+			mp_digit_fma (&h, &l, m[j], q, l);
+			h2 = h + mp_digit_add (&r[j - 1], l, h2);
+		}
+
+		c = mp_digit_add (&l, h1, h2) + mp_digit_add (&r[len - 1], l, c);
 	}
 
-	if (c != 0 || mp_cmp_n (r, m, len) >= 0)
-		mp_sub_n (r, r, m, len, 0);
+	mp_mod_norm_n_sec (r, r, m, len, c);
 }
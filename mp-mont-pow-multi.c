@@ -0,0 +1,256 @@
+/*
+ * MP Core Modular Multi-Exponentiation in Montgomery Form
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/alloc.h>
+#include <mp/bit.h>
+#include <mp/core.h>
+#include <mp/digit.h>
+#include <mp/mont-mul.h>
+#include <mp/unit.h>
+
+/*
+ * Accumulator (a, len) with flag full: A = A * X, or A = X if A is empty,
+ * that is one. Uses t as a temporary.
+ */
+static void mp_acc_mul (digit_t *a, digit_t *full, const digit_t *x,
+			digit_t *t, const digit_t *m, size_t len, digit_t mu)
+{
+	if (*full) {
+		mp_mont_mul_n (t, a, x, m, len, mu);
+		mp_copy (a, t, len);
+	}
+	else {
+		mp_copy (a, x, len);
+		*full = 1;
+	}
+}
+
+static void mp_acc_sqr (digit_t *a, digit_t full, digit_t *t,
+			const digit_t *m, size_t len, digit_t mu,
+			digit_t *ws)
+{
+	if (full) {
+		mp_mont_sqr_n_ws (t, a, m, len, mu, ws);
+		mp_copy (a, t, len);
+	}
+}
+
+/*
+ * Straus (Shamir) interleaved sliding windows: T[b][k] = X[b]^(2k + 1)
+ * for k < 2^(w - 1), exponent bits of all bases are scanned together
+ * from the top, thus squarings are shared. Window of base b starts at
+ * a set bit and ends at a set bit at position pos[b] - 1, where the
+ * table entry win[b] is multiplied in.
+ */
+static size_t mp_straus_itch (size_t count, size_t bits, size_t len)
+{
+	const size_t w = mp_mont_pow_window (bits);
+
+	return count * (len << (w - 1)) + count * 2 + len +
+	       mp_mont_sqr_itch (len);
+}
+
+static size_t mp_straus_cost (size_t count, size_t bits)
+{
+	const size_t w = mp_mont_pow_window (bits);
+
+	return count * (((size_t) 1 << (w - 1)) + bits / (w + 1));
+}
+
+static void mp_straus (digit_t *a, digit_t *full, const digit_t *x,
+		       const digit_t *y, size_t count, size_t bits,
+		       const digit_t *m, size_t len, digit_t mu,
+		       digit_t *ws)
+{
+	const size_t w = mp_mont_pow_window (bits);
+	const size_t n = (size_t) 1 << (w - 1);
+	digit_t *T = ws, *pos = T + count * n * len, *win = pos + count;
+	digit_t *t = win + count, *e;
+	const digit_t *yb;
+	size_t b, k, i, lo;
+
+	ws = t + len;
+
+	for (b = 0, e = T; b < count; ++b, e += n * len) {
+		mp_copy (e, x + b * len, len);
+
+		if (n > 1)
+			mp_mont_sqr_n_ws (t, e, m, len, mu, ws);
+
+		for (k = 1; k < n; ++k)
+			mp_mont_mul_n (e + k * len, e + (k - 1) * len, t,
+				       m, len, mu);
+
+		pos[b] = 0;
+	}
+
+	for (i = bits; i-- > 0;) {
+		mp_acc_sqr (a, *full, t, m, len, mu, ws);
+
+		for (b = 0; b < count; ++b) {
+			yb = y + b * len;
+
+			if (pos[b] == 0 && mp_bit (yb, i)) {
+				lo = i + 1 > w ? i + 1 - w : 0;
+
+				while (!mp_bit (yb, lo))
+					++lo;
+
+				win[b] = mp_bits (yb, len, lo, i + 1 - lo);
+				pos[b] = lo + 1;
+			}
+
+			if (pos[b] == i + 1) {
+				e = T + (b * n + (win[b] >> 1)) * len;
+				mp_acc_mul (a, full, e, t, m, len, mu);
+				pos[b] = 0;
+			}
+		}
+	}
+}
+
+/*
+ * Pippenger bucket method: exponents are split into c-bit digits, for
+ * every digit position from the top bases are multiplied into buckets
+ * B[k] by their digit value k, then product of B[k]^k is computed with
+ * running products S = B[n-1] ... B[k] and P = P S. Every position costs
+ * count + 2^(c + 1) multiplications and c squarings.
+ */
+static size_t mp_pippenger_window (size_t count)
+{
+	size_t c = 1;
+
+	while (c < 16 && (count + ((size_t) 4 << c)) * c <
+			 (count + ((size_t) 2 << c)) * (c + 1))
+		++c;
+
+	return c;
+}
+
+static size_t mp_pippenger_itch (size_t count, size_t len)
+{
+	const size_t n = (size_t) 1 << mp_pippenger_window (count);
+
+	return n * (len + 1) + len * 3 + mp_mont_sqr_itch (len);
+}
+
+static size_t mp_pippenger_cost (size_t count, size_t bits)
+{
+	const size_t c = mp_pippenger_window (count);
+
+	return (bits + c - 1) / c * (count + ((size_t) 2 << c));
+}
+
+static void mp_pippenger (digit_t *a, digit_t *full, const digit_t *x,
+			  const digit_t *y, size_t count, size_t bits,
+			  const digit_t *m, size_t len, digit_t mu,
+			  digit_t *ws)
+{
+	const size_t c = mp_pippenger_window (count);
+	const size_t n = (size_t) 1 << c;
+	digit_t *B = ws, *F = B + n * len, *S = F + n, *P = S + len;
+	digit_t *t = P + len, k, sf, pf;
+	size_t i, j, b;
+
+	ws = t + len;
+
+	for (i = (bits + c - 1) / c * c; i > 0; i -= c) {
+		for (j = 0; j < c; ++j)
+			mp_acc_sqr (a, *full, t, m, len, mu, ws);
+
+		mp_zero (F, n);
+
+		for (b = 0; b < count; ++b) {
+			k = mp_bits (y + b * len, len, i - c, c);
+
+			if (k != 0)
+				mp_acc_mul (B + k * len, F + k, x + b * len,
+					    t, m, len, mu);
+		}
+
+		for (k = n - 1, sf = pf = 0; k > 0; --k) {
+			if (F[k])
+				mp_acc_mul (S, &sf, B + k * len, t,
+					    m, len, mu);
+
+			if (sf)
+				mp_acc_mul (P, &pf, S, t, m, len, mu);
+		}
+
+		if (pf)
+			mp_acc_mul (a, full, P, t, m, len, mu);
+	}
+}
+
+/*
+ * If one is NULL then R = R * X[0]^Y[0] ... X[n-1]^Y[n-1], otherwise R is
+ * the product itself, where one = R mod M is the Montgomery one. The method
+ * with the lower estimated number of multiplications is used.
+ */
+static int mp_mont_pow_multi_core (digit_t *r, const digit_t *x,
+				   const digit_t *y, size_t count,
+				   const digit_t *one, const digit_t *m,
+				   size_t len, digit_t mu)
+{
+	size_t bits = 0, b, ylen, n, itch;
+	digit_t *a, *ws, full = 0;
+	int straus;
+
+	for (b = 0; b < count; ++b)
+		if ((ylen = mp_normalize (y + b * len, len)) > 0) {
+			n = ylen * MP_DIGIT_BITS -
+			    mp_digit_clz (y[b * len + ylen - 1]);
+			bits = n > bits ? n : bits;
+		}
+
+	if (bits == 0) {
+		if (one != NULL)
+			mp_copy (r, one, len);
+
+		return 1;
+	}
+
+	straus = mp_straus_cost (count, bits) <=
+		 mp_pippenger_cost (count, bits);
+	itch = straus ? mp_straus_itch (count, bits, len) :
+			mp_pippenger_itch (count, len);
+
+	if ((a = mp_alloc (len + itch)) == NULL)
+		return 0;
+
+	ws = a + len;
+
+	if (straus)
+		mp_straus (a, &full, x, y, count, bits, m, len, mu, ws);
+	else
+		mp_pippenger (a, &full, x, y, count, bits, m, len, mu, ws);
+
+	if (one != NULL)
+		mp_copy (r, a, len);
+	else {
+		mp_mont_mul_n (ws, r, a, m, len, mu);
+		mp_copy (r, ws, len);
+	}
+
+	mp_free (a);
+	return 1;
+}
+
+int mp_mont_pow_multi_n (digit_t *r, const digit_t *x, const digit_t *y,
+			 size_t count, const digit_t *m, size_t len,
+			 digit_t mu)
+{
+	return mp_mont_pow_multi_core (r, x, y, count, NULL, m, len, mu);
+}
+
+int mp_mont_pow_multi (const struct mp_mont_ctx *o, digit_t *r,
+		       const digit_t *x, const digit_t *y, size_t count)
+{
+	return mp_mont_pow_multi_core (r, x, y, count, o->one, o->m, o->len,
+				       o->mu);
+}
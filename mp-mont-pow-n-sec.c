@@ -6,23 +6,117 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <mp/alloc.h>
+#include <mp/bit.h>
 #include <mp/mont-mul.h>
 #include <mp/unit.h>
 
-void mp_mont_pow_n_sec (digit_t *r, const digit_t *x, const digit_t *y,
-			const digit_t *m, size_t len, digit_t mu)
+/*
+ * Left-to-right fixed window exponentiation: T[i] = X^i for i < 2^w, all
+ * len * w bits of exponent processed, every window costs w squarings and
+ * one multiplication. If one is NULL then R = R * X^Y, otherwise R = X^Y,
+ * where one = R mod M is the Montgomery one. The Montgomery multiplication
+ * and squaring kernels are constant-flow, see mp/mont-mul.h.
+ */
+static void mp_mont_pow_sec_core (digit_t *r, const digit_t *x,
+				  const digit_t *y, const digit_t *one,
+				  const digit_t *m, size_t len, digit_t mu,
+				  digit_t *ws)
 {
-	size_t i, j;
-	digit_t d, X[len], t[len];
+	const size_t bits = len * MP_DIGIT_BITS;
+	const size_t w = mp_mont_pow_window (bits);
+	const size_t n = (size_t) 1 << w;
+	size_t i, j, k;
+	digit_t *T = ws, *A = T + n * len, *t = A + len;
+
+	if (one != NULL)
+		mp_copy (T, one, len);
+	else {
+		/* T[0] = R mod M: pull R^2 mod M from Montgomery form */
+		mp_mont_ro_gen_ws (T, m, len, T + len);
+		mp_mont_pull_n (T, T, m, len, mu);
+	}
+
+	mp_copy (T + len, x, len);
+
+	for (k = 2; k < n; ++k)
+		mp_mont_mul_n (T + k * len, T + (k - 1) * len, x, m, len, mu);
+
+	ws = t + len;
+	i  = (bits - 1) / w * w;  /* position of the top window */
+
+	mp_select (A, T, n, len, mp_bits (y, len, i, bits - i));
+
+	while (i > 0) {
+		i -= w;
+
+		for (j = 0; j < w; ++j) {
+			mp_mont_sqr_n_ws (t, A, m, len, mu, ws);
+			mp_copy (A, t, len);
+		}
+
+		mp_select (t, T, n, len, mp_bits (y, len, i, w));
+		mp_mont_mul_n (ws, A, t, m, len, mu);
+		mp_copy (A, ws, len);
+	}
+
+	if (one != NULL) {
+		mp_copy (r, A, len);
+		return;
+	}
+
+	mp_mont_mul_n (t, r, A, m, len, mu);
+	mp_copy (r, t, len);
+}
+
+void mp_mont_pow_n_sec_ws (digit_t *r, const digit_t *x, const digit_t *y,
+			   const digit_t *m, size_t len, digit_t mu,
+			   digit_t *ws)
+{
+	mp_mont_pow_sec_core (r, x, y, NULL, m, len, mu, ws);
+}
+
+/*
+ * Binary exponentiation with multiplication for every exponent bit, used
+ * if workspace cannot be allocated: it needs 2 len digits only.
+ */
+static void mp_mont_pow_sec_bin (digit_t *r, const digit_t *x,
+				 const digit_t *y, const digit_t *m,
+				 size_t len, digit_t mu)
+{
+	size_t i, j, k;
+	digit_t d, mask, X[len], t[len];
 
 	mp_copy (X, x, len);
 
 	for (i = 0; i < len; ++i)
 		for (j = 0, d = y[i]; j < MP_DIGIT_BITS; ++j, d >>= 1) {
 			mp_mont_mul_n (t, r, X, m, len, mu);
-			mp_copy ((d & 1) != 0 ? r : t, t, len);
+			mask = 0 - (d & 1);
+
+			for (k = 0; k < len; ++k)
+				r[k] = (t[k] & mask) | (r[k] & ~mask);
 
 			mp_mont_mul_n (t, X, X, m, len, mu);
 			mp_copy (X, t, len);
 		}
 }
+
+void mp_mont_pow_n_sec (digit_t *r, const digit_t *x, const digit_t *y,
+			const digit_t *m, size_t len, digit_t mu)
+{
+	digit_t *ws;
+
+	if ((ws = mp_alloc (mp_mont_pow_itch (len))) == NULL)
+		mp_mont_pow_sec_bin (r, x, y, m, len, mu);
+	else {
+		mp_mont_pow_n_sec_ws (r, x, y, m, len, mu, ws);
+		mp_free (ws);
+	}
+}
+
+void mp_mont_pow_sec (const struct mp_mont_ctx *o, digit_t *r,
+		      const digit_t *x, const digit_t *y)
+{
+	mp_mont_pow_sec_core (r, x, y, o->one, o->m, o->len, o->mu, o->ws);
+}
@@ -6,11 +6,102 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <mp/alloc.h>
+#include <mp/bit.h>
+#include <mp/core.h>
+#include <mp/digit.h>
 #include <mp/mont-mul.h>
 #include <mp/unit.h>
 
-void mp_mont_pow_n (digit_t *r, const digit_t *x, const digit_t *y,
-		    const digit_t *m, size_t len, digit_t mu)
+/*
+ * Left-to-right sliding window exponentiation: T[i] = X^(2i + 1) for
+ * i < 2^(w - 1), every window starts and ends with a set bit, leading
+ * zero bits of exponent are skipped. If one is NULL then R = R * X^Y,
+ * otherwise R = X^Y, where one = R mod M is the Montgomery one.
+ */
+static void mp_mont_pow_core (digit_t *r, const digit_t *x, const digit_t *y,
+			      const digit_t *one,
+			      const digit_t *m, size_t len, digit_t mu,
+			      digit_t *ws)
+{
+	const size_t ylen = mp_normalize (y, len);
+	size_t bits, w, n, i, j, k, e;
+	digit_t *T = ws, *A, *t, *s;
+
+	if (ylen == 0) {
+		if (one != NULL)
+			mp_copy (r, one, len);
+
+		return;
+	}
+
+	bits = ylen * MP_DIGIT_BITS - mp_digit_clz (y[ylen - 1]);
+	w    = mp_mont_pow_window (bits);
+	n    = (size_t) 1 << (w - 1);
+	A    = T + n * len;
+	t    = A + len;
+	ws   = t + len;
+
+	mp_copy (T, x, len);
+
+	if (n > 1)
+		mp_mont_sqr_n_ws (A, x, m, len, mu, ws);
+
+	for (k = 1; k < n; ++k)
+		mp_mont_mul_n (T + k * len, T + (k - 1) * len, A, m, len, mu);
+
+	for (i = bits, s = NULL; i > 0; i = j) {
+		if (!mp_bit (y, i - 1)) {
+			mp_mont_sqr_n_ws (t, A, m, len, mu, ws);
+			s = A, A = t, t = s;
+			j = i - 1;
+			continue;
+		}
+
+		j = i > w ? i - w : 0;  /* window is [j, i) */
+
+		while (!mp_bit (y, j))
+			++j;
+
+		for (e = 0, k = i; k > j; --k)
+			e = (e << 1) | mp_bit (y, k - 1);
+
+		if (s == NULL) {  /* first window */
+			mp_copy (A, T + (e >> 1) * len, len);
+			s = A;
+			continue;
+		}
+
+		for (k = i; k > j; --k) {
+			mp_mont_sqr_n_ws (t, A, m, len, mu, ws);
+			s = A, A = t, t = s;
+		}
+
+		mp_mont_mul_n (t, A, T + (e >> 1) * len, m, len, mu);
+		s = A, A = t, t = s;
+	}
+
+	if (one != NULL) {
+		mp_copy (r, A, len);
+		return;
+	}
+
+	mp_mont_mul_n (t, r, A, m, len, mu);
+	mp_copy (r, t, len);
+}
+
+void mp_mont_pow_n_ws (digit_t *r, const digit_t *x, const digit_t *y,
+		       const digit_t *m, size_t len, digit_t mu, digit_t *ws)
+{
+	mp_mont_pow_core (r, x, y, NULL, m, len, mu, ws);
+}
+
+/*
+ * Right-to-left binary exponentiation, used if workspace cannot be
+ * allocated: it needs 2 len digits only.
+ */
+static void mp_mont_pow_bin (digit_t *r, const digit_t *x, const digit_t *y,
+			     const digit_t *m, size_t len, digit_t mu)
 {
 	size_t i, j;
 	digit_t d, X[len], t[len];
@@ -28,3 +119,22 @@ void mp_mont_pow_n (digit_t *r, const digit_t *x, const digit_t *y,
 			mp_copy (X, t, len);
 		}
 }
+
+void mp_mont_pow_n (digit_t *r, const digit_t *x, const digit_t *y,
+		    const digit_t *m, size_t len, digit_t mu)
+{
+	digit_t *ws;
+
+	if ((ws = mp_alloc (mp_mont_pow_itch (len))) == NULL)
+		mp_mont_pow_bin (r, x, y, m, len, mu);
+	else {
+		mp_mont_pow_n_ws (r, x, y, m, len, mu, ws);
+		mp_free (ws);
+	}
+}
+
+void mp_mont_pow (const struct mp_mont_ctx *o, digit_t *r, const digit_t *x,
+		  const digit_t *y)
+{
+	mp_mont_pow_core (r, x, y, o->one, o->m, o->len, o->mu, o->ws);
+}
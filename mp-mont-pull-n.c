@@ -6,26 +6,35 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <mp/digit.h>
+#include <mp/mod.h>
 #include <mp/mont-mul.h>
-#include <mp/mul.h>
-#include <mp/shift.h>
 #include <mp/unit.h>
 
+/*
+ * Every REDC step adds M * q and stores the sum shifted down by one digit
+ * in the same pass, thus no separate word shift required. The sum always
+ * fits into len digits: T < B^len and M < B^len gives (T + qM) / B < B^len.
+ */
 void mp_mont_pull_n (digit_t *r, const digit_t *x,
 		     const digit_t *m, size_t len, digit_t mu)
 {
-	digit_t h;
-	size_t i;
+	digit_t q, h, l, c;
+	size_t i, j;
 
 	mp_copy (r, x, len);
-	h = mp_addmul_1 (r, m, len, mu * r[0], 0);
-	mp_rshift_word (r, r, len, h);
 
-	for (i = 1; i < len; ++i) {
-		h = mp_addmul_1 (r, m, len, mu * r[0], 0);
-		mp_rshift_word (r, r, len, h);
+	for (i = 0; i < len; ++i) {
+		q = mu * r[0];
+		mp_digit_fma (&c, &l, m[0], q, r[0]);  /* l = 0 here */
+
+		for (j = 1; j < len; ++j) {
+			mp_digit_fma (&h, &l, m[j], q, r[j]);
+			c = h + mp_digit_add (&r[j - 1], l, c);
+		}
+
+		r[len - 1] = c;
 	}
 
-	if (mp_cmp_n (r, m, len) >= 0)
-		mp_sub_n (r, r, m, len, 0);
+	mp_mod_norm_n_sec (r, r, m, len, 0);
 }
@@ -6,41 +6,65 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <mp/alloc.h>
 #include <mp/digit.h>
 #include <mp/div.h>
 #include <mp/mont-mul.h>
 #include <mp/shift.h>
 #include <mp/unit.h>
 
-void mp_mont_ro_gen (digit_t *r, const digit_t *m, size_t len)
+/*
+ * R^2 mod M by doubling of a power of two below M, needs no workspace.
+ */
+static void mp_mont_ro_gen_slow (digit_t *r, const digit_t *m, size_t len)
+{
+	const size_t s = mp_digit_clz (m[len - 1]);
+	size_t i, j;
+
+	mp_zero (r, len - 1);
+	r[len - 1] = (digit_t) 1 << (MP_DIGIT_BITS - 1 - s);
+
+	for (i = 0; i < len; ++i)
+		for (j = 0; j < MP_DIGIT_BITS; ++j)
+			mp_mod_add_n (r, r, r, m, len);
+
+	for (j = 0; j <= s; ++j)
+		mp_mod_add_n (r, r, r, m, len);
+}
+
+void mp_mont_ro_gen_ws (digit_t *r, const digit_t *m, size_t len, digit_t *ws)
 {
 #ifndef HAVE_SLOW_DIV
 	const size_t n = len * 2;
 	const int shift = mp_digit_clz (m[len - 1]);
-	digit_t R2[n + 1], ms[len];
+	digit_t *R2 = ws, *ms = R2 + n + 1;
 
 	/* R^2 * 2^shift, where R = B^len */
 	mp_zero (R2, n); R2[n] = (digit_t) 1 << shift;
 
+	/* the remainder takes nlen digits, thus reduce in place */
 	if (shift != 0) {
 		mp_lshift (ms, m, len, 0, shift);
-		mp_mod (r, R2, n + 1, ms, len);
-		mp_rshift (r, r, len, 0, shift);
+		mp_mod (R2, R2, n + 1, ms, len);
+		mp_rshift (r, R2, len, 0, shift);
+	}
+	else {
+		mp_mod (R2, R2, n + 1, m, len);
+		mp_copy (r, R2, len);
 	}
-	else
-		mp_mod (r, R2, n + 1, m, len);
 #else
-	const int s = mp_digit_clz (m[len - 1]);
-	size_t i, j;
-
-	mp_zero (r, len - 1);
-	r[len - 1] = (digit_t) 1 << (MP_DIGIT_BITS - 1 - s);
+	mp_mont_ro_gen_slow (r, m, len);
+#endif
+}
 
-	for (i = 0; i < len; ++i)
-		for (j = 0; j < MP_DIGIT_BITS; ++j)
-			mp_mod_add_n (r, r, r, m, len);
+void mp_mont_ro_gen (digit_t *r, const digit_t *m, size_t len)
+{
+	digit_t *ws;
 
-	for (j = 0; j <= s; ++j)
-		mp_mod_add_n (r, r, r, m, len);
-#endif
+	if ((ws = mp_alloc (mp_mont_ro_itch (len))) == NULL)
+		mp_mont_ro_gen_slow (r, m, len);
+	else {
+		mp_mont_ro_gen_ws (r, m, len, ws);
+		mp_free (ws);
+	}
 }
@@ -6,22 +6,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <mp/alloc.h>
 #include <mp/digit.h>
 #include <mp/div.h>
 #include <mp/mont-mul.h>
 #include <mp/shift.h>
 #include <mp/unit.h>
 
-void mp_mont_ro (digit_t *r, const digit_t *m, size_t len)
+/*
+ * R^2 mod M by doubling of R mod M, needs no workspace.
+ */
+static void mp_mont_ro_slow (digit_t *r, const digit_t *m, size_t len)
 {
-#ifndef HAVE_SLOW_DIV
-	const size_t n = len * 2;
-	digit_t R2[n + 1];
-
-	mp_zero (R2, n); R2[n] = 1;  /* R^2, where R = B^len */
-
-	mp_mod (r, R2, n + 1, m, len);
-#else
 	size_t i, j;
 
 	mp_neg (r, m, len);
@@ -29,5 +25,32 @@ void mp_mont_ro (digit_t *r, const digit_t *m, size_t len)
 	for (i = 0; i < len; ++i)
 		for (j = 0; j < MP_DIGIT_BITS; ++j)
 			mp_mod_add_n (r, r, r, m, len);
+}
+
+void mp_mont_ro_ws (digit_t *r, const digit_t *m, size_t len, digit_t *ws)
+{
+#ifndef HAVE_SLOW_DIV
+	const size_t n = len * 2;
+	digit_t *R2 = ws;
+
+	mp_zero (R2, n); R2[n] = 1;  /* R^2, where R = B^len */
+
+	/* the remainder takes nlen digits, thus reduce in place */
+	mp_mod (R2, R2, n + 1, m, len);
+	mp_copy (r, R2, len);
+#else
+	mp_mont_ro_slow (r, m, len);
 #endif
 }
+
+void mp_mont_ro (digit_t *r, const digit_t *m, size_t len)
+{
+	digit_t *ws;
+
+	if ((ws = mp_alloc (mp_mont_ro_itch (len))) == NULL)
+		mp_mont_ro_slow (r, m, len);
+	else {
+		mp_mont_ro_ws (r, m, len, ws);
+		mp_free (ws);
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * MP Core Modular Arithmetics: Montgomery Squaring
+ *
+ * Copyright (c) 2014-2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/alloc.h>
+#include <mp/digit.h>
+#include <mp/mod.h>
+#include <mp/mont-fixed.h>
+#include <mp/mont-mul.h>
+#include <mp/mul.h>
+#include <mp/unit.h>
+
+/*
+ * The full square is computed first with mp_sqr, which computes cross
+ * products only once, then it is reduced with one REDC pass. For small
+ * moduli with straight-line multiplication kernel the call overhead of
+ * mp_sqr outweighs the saved products, thus the kernel is used instead.
+ * The kernel is used for huge moduli as well: the transform squaring is
+ * not constant-flow, and quadratic REDC pass dominates there anyway.
+ */
+void mp_mont_sqr_n_ws (digit_t *r, const digit_t *x,
+		       const digit_t *m, size_t len, digit_t mu, digit_t *ws)
+{
+	digit_t *t = ws, h;
+	char c;
+	size_t i;
+
+	if (mp_mont_fixed_flat (len) || len >= MP_NTT_CUTOFF) {
+		mp_mont_mul_n (t, x, x, m, len, mu);
+		mp_copy (r, t, len);
+		return;
+	}
+
+	mp_sqr_ws (t, x, len, ws + len * 2);
+
+	for (i = 0, c = 0; i < len; ++i) {
+		h = mp_addmul_1 (t + i, m, len, mu * t[i], 0);
+		c = mp_digit_adc (t + len + i, t[len + i], h, c);
+	}
+
+	mp_mod_norm_n_sec (r, t + len, m, len, c);
+}
+
+/*
+ * If workspace cannot be allocated then multiplication kernel is used,
+ * it needs len digits only for the result.
+ */
+void mp_mont_sqr_n (digit_t *r, const digit_t *x,
+		    const digit_t *m, size_t len, digit_t mu)
+{
+	digit_t *ws;
+
+	if ((ws = mp_alloc (mp_mont_sqr_itch (len))) == NULL) {
+		digit_t t[len];
+
+		mp_mont_mul_n (t, x, x, m, len, mu);
+		mp_copy (r, t, len);
+	}
+	else {
+		mp_mont_sqr_n_ws (r, x, m, len, mu, ws);
+		mp_free (ws);
+	}
+}
@@ -9,9 +9,12 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <mp/alloc.h>
 #include <mp/conv.h>
 #include <mp/core.h>
+#include <mp/ec.h>
 #include <mp/mont-mul.h>
+#include <mp/rsa.h>
 #include <mp/unit.h>
 
 #ifndef ARRAY_SIZE
@@ -208,6 +211,128 @@ static int do_push_tests (void)
 	return 1;
 }
 
+static int do_sqr_test (const struct push_sample *o)
+{
+	digit_t m[8], mu, ro[8], a[8], am[8], r[8], s[8];
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), o->M);
+	int ok;
+
+	printf ("sqr test:\n");
+	mp_show ("\tM  = ", m, len);
+
+	mu = mp_mont_mu (m[0]);
+	mp_mont_ro_gen (ro, m, len);
+
+	mp_load_hex (a, ARRAY_SIZE (a), o->A);  /* use mp_zext in generic case */
+	mp_show ("\tA  = ", a, len);
+
+	mp_mont_push_n (am, a, ro, m, len, mu);
+	mp_mont_mul_n (r, am, am, m, len, mu);
+	mp_mont_sqr_n (s, am, m, len, mu);
+
+	ok = mp_cmp_n (r, s, len) == 0;
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_sqr_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (push_sample); ++i)
+		if (!do_sqr_test (push_sample + i))
+			return 0;
+
+	return 1;
+}
+
+static int do_inv_test (const char *M, const char *A, int invertible)
+{
+	digit_t m[8], mu, ro[8], a[8], am[8], im[8], rm[8], r[8];
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), M);
+	int ok;
+
+	printf ("inv test:\n");
+	mp_show ("\tM  = ", m, len);
+
+	mu = mp_mont_mu (m[0]);
+	mp_mont_ro_gen (ro, m, len);
+
+	mp_zero (a, len);
+	mp_load_hex (a, ARRAY_SIZE (a), A);
+	mp_show ("\tA  = ", a, len);
+
+	mp_mont_push_n (am, a, ro, m, len, mu);
+	ok = mp_mont_inv_n (im, am, ro, m, len, mu) == invertible;
+
+	if (invertible) {
+		mp_mont_mul_n (rm, am, im, m, len, mu);  /* R = A * A^-1 */
+		mp_mont_pull_n (r, rm, m, len, mu);
+
+		ok &= mp_normalize (r, len) == 1 && r[0] == 1;
+	}
+
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_inv_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (push_sample); ++i)
+		if (!do_inv_test (push_sample[i].M, push_sample[i].A, 1))
+			return 0;
+
+	/* M = SHA('') is divisible by 5, A = 1000 */
+	return do_inv_test (push_sample[1].M, "3e8", 0);
+}
+
+static int do_inv_batch_test (const struct push_sample *o)
+{
+	digit_t m[8], mu, ro[8], a[8], x[4 * 8], y[4 * 8], rm[8], r[8];
+	digit_t ws[mp_mont_inv_batch_itch (ARRAY_SIZE (m))];
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), o->M), i;
+	int ok;
+
+	printf ("inv batch test:\n");
+	mp_show ("\tM  = ", m, len);
+
+	mu = mp_mont_mu (m[0]);
+	mp_mont_ro_gen (ro, m, len);
+
+	mp_load_hex (a, ARRAY_SIZE (a), o->A);  /* use mp_zext in generic case */
+	mp_show ("\tA  = ", a, len);
+
+	mp_mont_push_n (x, a, ro, m, len, mu);	/* X[i] = A^(i + 1) */
+
+	for (i = 1; i < 4; ++i)
+		mp_mont_mul_n (x + i * len, x + (i - 1) * len, x, m, len, mu);
+
+	ok = mp_mont_inv_batch (y, x, 4, ro, m, len, mu, ws);
+
+	for (i = 0; i < 4; ++i) {
+		mp_mont_mul_n (rm, x + i * len, y + i * len, m, len, mu);
+		mp_mont_pull_n (r, rm, m, len, mu);
+
+		ok &= mp_normalize (r, len) == 1 && r[0] == 1;
+	}
+
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_inv_batch_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (push_sample); ++i)
+		if (!do_inv_batch_test (push_sample + i))
+			return 0;
+
+	return 1;
+}
+
 struct pow_sample {
 	const char *M, *A, *B, *P;
 };
@@ -257,7 +382,7 @@ static const struct pow_sample pow_sample[] = {
 
 static int do_pow_test (const struct pow_sample *o)
 {
-	digit_t m[8], mu, ro[8], a[8], am[8], b[8], rm[8], r[8], p[8];
+	digit_t m[8], mu, ro[8], a[8], am[8], b[8], rm[8], r[8], p[8], s[8];
 	size_t len = mp_load_hex (m, ARRAY_SIZE (m), o->M);
 	int ok;
 
@@ -281,9 +406,13 @@ static int do_pow_test (const struct pow_sample *o)
 	mp_mont_pull_n (r, rm, m, len, mu);
 	mp_show ("\tR  = ", r, len);
 
+	mp_copy (rm, am, len);
+	mp_mont_pow_n_sec (rm, am, b, m, len, mu);
+	mp_mont_pull_n (s, rm, m, len, mu);
+
 	mp_load_hex (p, ARRAY_SIZE (p), o->P);  /* use mp_zext in generic case */
 
-	ok = mp_cmp_n (r, p, len) == 0;
+	ok = mp_cmp_n (r, p, len) == 0 && mp_cmp_n (s, p, len) == 0;
 	printf ("\t%s\n", ok ? "passed" : "failed");
 	return ok;
 }
@@ -299,8 +428,491 @@ static int do_pow_tests (void)
 	return 1;
 }
 
+/*
+ * Functions without _ws suffix must fall back to methods with small stack
+ * usage if workspace allocation failed.
+ */
+static void *fail_alloc (void *ctx, size_t size)
+{
+	(void) ctx, (void) size;
+	return NULL;
+}
+
+static void *fail_realloc (void *ctx, void *p, size_t size)
+{
+	(void) ctx, (void) p, (void) size;
+	return NULL;
+}
+
+static void fail_free (void *ctx, void *p)
+{
+	(void) ctx, (void) p;
+}
+
+static const struct mp_allocator fail_allocator = {
+	fail_alloc, fail_realloc, fail_free, NULL
+};
+
+static int do_fallback_tests (void)
+{
+	const struct mp_allocator *prev = mp_set_allocator (&fail_allocator);
+	int ok;
+
+	printf ("fallback tests:\n");
+
+	ok = do_sqr_tests () && do_pow_tests ();
+	mp_set_allocator (prev);
+	return ok;
+}
+
+#define MULTI_COUNT  200
+
+static int do_pow_multi_test (const struct pow_sample *o)
+{
+	struct mp_mont_ctx c;
+	digit_t m[8], a[8], am[8], b[8], rm[8], sm[8], r[8], s[8], p[8];
+	digit_t x[MULTI_COUNT * 8], y[MULTI_COUNT * 8], e;
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), o->M), i;
+	int ok;
+
+	printf ("pow multi test:\n");
+
+	if (!mp_mont_init (&c, m, len)) {
+		printf ("\tcannot allocate context\n");
+		return 0;
+	}
+
+	mp_show ("\tM  = ", m, len);
+
+	mp_load_hex (a, ARRAY_SIZE (a), o->A);  /* use mp_zext in generic case */
+	mp_load_hex (b, ARRAY_SIZE (b), o->B);  /* use mp_zext in generic case */
+	mp_load_hex (p, ARRAY_SIZE (p), o->P);  /* use mp_zext in generic case */
+
+	mp_mont_push (&c, am, a);
+
+	/* P = A^B * A^1, two bases */
+	mp_copy (x, am, len);
+	mp_copy (x + len, am, len);
+	mp_copy (y, b, len);
+	mp_zero (y + len, len);
+	y[len] = 1;
+
+	ok = mp_mont_pow_multi (&c, rm, x, y, 2);
+	mp_mont_pull (&c, r, rm);
+	mp_show ("\tR  = ", r, len);
+
+	ok &= mp_cmp_n (r, p, len) == 0;
+
+	/* prod (A^i)^i = A^e, many bases with short exponents */
+	for (i = 0, e = 0; i < MULTI_COUNT; ++i) {
+		if (i == 0)
+			mp_copy (x, am, len);
+		else
+			mp_mont_mul (&c, x + i * len, x + (i - 1) * len, am);
+
+		mp_zero (y + i * len, len);
+		y[i * len] = i + 1;
+		e += (i + 1) * (i + 1);
+	}
+
+	ok &= mp_mont_pow_multi (&c, rm, x, y, MULTI_COUNT);
+	mp_mont_pull (&c, r, rm);
+
+	mp_zero (b, len);
+	b[0] = e;
+	mp_mont_pow (&c, sm, am, b);
+	mp_mont_pull (&c, s, sm);
+
+	mp_mont_fini (&c);
+
+	ok &= mp_cmp_n (r, s, len) == 0;
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_pow_multi_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (pow_sample); ++i)
+		if (!do_pow_multi_test (pow_sample + i))
+			return 0;
+
+	return 1;
+}
+
+static int do_comb_test (const struct pow_sample *o)
+{
+	struct mp_mont_ctx c;
+	struct mp_mont_comb g, h;
+	digit_t m[8], a[8], am[8], b[8], rm[8], sm[8], r[8], s[8], p[8];
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), o->M);
+	size_t bits = len * MP_DIGIT_BITS;
+	int ok;
+
+	printf ("comb test:\n");
+
+	if (!mp_mont_init (&c, m, len)) {
+		printf ("\tcannot allocate context\n");
+		return 0;
+	}
+
+	mp_show ("\tM  = ", m, len);
+
+	mp_load_hex (a, ARRAY_SIZE (a), o->A);  /* use mp_zext in generic case */
+	mp_load_hex (b, ARRAY_SIZE (b), o->B);  /* use mp_zext in generic case */
+	mp_load_hex (p, ARRAY_SIZE (p), o->P);  /* use mp_zext in generic case */
+
+	mp_mont_push (&c, am, a);
+
+	if (mp_mont_comb_init (&g, &c, am, bits, 0) ||
+	    mp_mont_comb_init (&g, &c, am, bits, MP_DIGIT_BITS) ||
+	    mp_mont_comb_init (&g, &c, am, bits + 1, 4)) {
+		mp_mont_comb_fini (&g);
+		mp_mont_fini (&c);
+		printf ("\tinvalid comb parameters accepted\n");
+		return 0;
+	}
+
+	if (!mp_mont_comb_init (&g, &c, am, bits,
+				mp_mont_comb_teeth (bits, 0)))
+		goto no_g;
+
+	if (!mp_mont_comb_init (&h, &c, am, bits,
+				mp_mont_comb_teeth (bits, 1)))
+		goto no_h;
+
+	mp_mont_comb_pow (&g, sm, b);
+	mp_mont_mul (&c, rm, sm, am);
+	mp_mont_pull (&c, r, rm);
+	mp_show ("\tR  = ", r, len);
+
+	mp_mont_comb_pow_sec (&h, sm, b);
+	mp_mont_mul (&c, rm, sm, am);
+	mp_mont_pull (&c, s, rm);
+
+	mp_mont_comb_fini (&h);
+	mp_mont_comb_fini (&g);
+	mp_mont_fini (&c);
+
+	ok = mp_cmp_n (r, p, len) == 0 && mp_cmp_n (s, p, len) == 0;
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+no_h:
+	mp_mont_comb_fini (&g);
+no_g:
+	mp_mont_fini (&c);
+	printf ("\tcannot allocate comb\n");
+	return 0;
+}
+
+static int do_comb_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (pow_sample); ++i)
+		if (!do_comb_test (pow_sample + i))
+			return 0;
+
+	return 1;
+}
+
+static int do_ctx_test (const struct pow_sample *o)
+{
+	struct mp_mont_ctx c;
+	digit_t m[8], a[8], am[8], b[8], rm[8], sm[8], r[8], s[8], p[8];
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), o->M);
+	int ok;
+
+	printf ("ctx test:\n");
+
+	if (!mp_mont_init (&c, m, len)) {
+		printf ("\tcannot allocate context\n");
+		return 0;
+	}
+
+	mp_show ("\tM  = ", m, len);
+
+	mp_load_hex (a, ARRAY_SIZE (a), o->A);  /* use mp_zext in generic case */
+	mp_load_hex (b, ARRAY_SIZE (b), o->B);  /* use mp_zext in generic case */
+	mp_load_hex (p, ARRAY_SIZE (p), o->P);  /* use mp_zext in generic case */
+
+	mp_mont_push (&c, am, a);
+
+	mp_mont_pow (&c, sm, am, b);
+	mp_mont_mul (&c, rm, sm, am);
+	mp_mont_pull (&c, r, rm);
+	mp_show ("\tR  = ", r, len);
+
+	mp_mont_pow_sec (&c, sm, am, b);
+	mp_mont_mul (&c, rm, sm, am);
+	mp_mont_pull (&c, s, rm);
+
+	ok = mp_cmp_n (r, p, len) == 0 && mp_cmp_n (s, p, len) == 0;
+
+	/* (A^-1)^B * A^(B+1) = A */
+	ok &= mp_mont_inv (&c, sm, am);
+	mp_mont_pow (&c, rm, sm, b);
+	mp_mont_pow (&c, sm, am, b);
+	mp_mont_mul (&c, r, sm, am);
+	mp_mont_mul (&c, sm, rm, r);
+	mp_mont_pull (&c, r, sm);
+
+	mp_mont_fini (&c);
+
+	ok &= mp_cmp_n (r, a, len) == 0;
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_ctx_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (pow_sample); ++i)
+		if (!do_ctx_test (pow_sample + i))
+			return 0;
+
+	return 1;
+}
+
+struct rsa_sample {
+	const char *P, *Q, *D, *E, *C, *M;
+};
+
+static const struct rsa_sample rsa_sample[] = {
+	{
+		"f24a8cdc167edfdaec7ea1c99d6d1f17a28e6d2ae81b9fcc35d25ae0d45d1139",
+		"f7d3655f7015b276bc31604e68e13ae49284528390753036c4610240b87841ab",
+		"74ee9677052d6cbf0379a74e051c4054f21e74de478a39501c58bbfa183d846e"
+		"c76cf185a85dae07b5e24fd56004477adff1676a9cd86c6c1cd20a8f7cc94e1",
+		"10001",
+		"8b544a4d65682f483da7b7588ca422826884348bc3b4b54fc2a6d69331ea8f9f"
+		"d213cfb2ca24d8ec3ab91cc8a5d4e386a83ed1062a863e6c41457a82547e1dfb",
+		"54686520717569636b2062726f776e20666f78206a756d7073206f7665722074"
+		"6865206c617a7920646f67",
+	},
+};
+
+static void mp_load_zx (digit_t *x, size_t len, const char *hex)
+{
+	size_t n = mp_load_hex (x, len, hex);
+
+	mp_zero (x + n, len - n);
+}
+
+static int do_rsa_test (const struct rsa_sample *o)
+{
+	struct mp_rsa k;
+	digit_t p[4], q[4], d[8], e[8], c[8], m[8], r[8];
+	size_t len = mp_load_hex (p, ARRAY_SIZE (p), o->P);
+	int ok;
+
+	printf ("rsa test:\n");
+
+	mp_load_hex (q, ARRAY_SIZE (q), o->Q);
+	mp_load_zx (d, ARRAY_SIZE (d), o->D);
+	mp_load_zx (e, ARRAY_SIZE (e), o->E);
+	mp_load_zx (c, ARRAY_SIZE (c), o->C);
+	mp_load_zx (m, ARRAY_SIZE (m), o->M);
+
+	if (!mp_rsa_init (&k, p, q, len, d, e)) {
+		printf ("\tcannot initialize key\n");
+		return 0;
+	}
+
+	ok = mp_rsa_crt (&k, r, c);
+	mp_show ("\tR  = ", r, len * 2);
+	ok &= mp_cmp_n (r, m, len * 2) == 0;
+
+	/* faulty dP must be detected */
+	k.dp[0] ^= 2;
+	ok &= !mp_rsa_crt (&k, r, c) && mp_normalize (r, len * 2) == 0;
+
+	mp_rsa_fini (&k);
+
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_rsa_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (rsa_sample); ++i)
+		if (!do_rsa_test (rsa_sample + i))
+			return 0;
+
+	return 1;
+}
+
+struct ec_sample {
+	const char *P, *A, *B, *Gx, *Gy, *K, *Rx, *Ry, *U, *V, *Sx, *Sy;
+};
+
+static const struct ec_sample ec_sample[] = {
+	{  /* P-256 */
+		"ffffffff00000001000000000000000000000000ffffffffffffffffffffffff",
+		"ffffffff00000001000000000000000000000000fffffffffffffffffffffffc",
+		"5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b",
+		"6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+		"4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5",
+		"ee544eeb36cbb40403ed3511d7ec202ad7f20e07ed4202edc4bb895c608099f6",
+		"a3a2ece705b590713a032361210cdd4ff7a2aca728377aecc12209ed11c5d651",
+		"a04b2aebee348b20e29e320d331308951039e6d0ce38a3bcd72d2ede287ce345",
+		"c1e3efacf3f5fa17dba8b6150ada35d1793bfb39a2ef283a4e0433b7df28434d",
+		"dbcf34d896a8dab3189d51ec6c90847f9092a4d94e4f86d708e369b041747c23",
+		"a6b1f293d81281f40eb9e1d3001868cce8cc5567ae4ae650f0af7f8a159c03f0",
+		"7e3fdb2fd18fede0ca35c78db9ee603758ed607413e5ee7f7e8b2c075ccfbfd0",
+	},
+	{  /* secp256k1 */
+		"fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f",
+		"0",
+		"7",
+		"79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798",
+		"483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8",
+		"f6a6c4118327575b32776fead50db719ba9e5c47afca1560936e0b4f1fd8218a",
+		"379c25cb822a3405c22fa4a0c09f15caf3b17a26f0fa21e086604b88969a58d2",
+		"b93a22a22c5dbf674e568249832e2182cc09e7ad08bde9f86fcbac11f29c9d08",
+		"8c7d38462e52011aeb2842b9d326e9c250c4d7db9ffeafc4f1fb2337cb61c8ad",
+		"d563fe7ef91d8131e220bb921a9eb423864f96bf782a3ae88384a7f75bd2470b",
+		"12ce24a9cdafc85234af7cca868173889e7c61418337fd6c70d6b221ea815d8",
+		"221230e4ee32533ef6f9d1d04d40f95a44f970dcacfe411c3c1e20a3e04182b7",
+	},
+	{  /* P-521 */
+		"1fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+		"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+		"fff",
+		"1fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+		"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+		"ffc",
+		"51953eb9618e1c9a1f929a21a0b68540eea2da725b99b315f3b8b489918ef109"
+		"e156193951ec7e937b1652c0bd3bb1bf073573df883d2c34f1ef451fd46b503f"
+		"00",
+		"c6858e06b70404e9cd9e3ecb662395b4429c648139053fb521f828af606b4d3d"
+		"baa14b5e77efe75928fe1dc127a2ffa8de3348b3c1856a429bf97e7e31c2e5bd"
+		"66",
+		"11839296a789a3bc0045c8a5fb42c7d1bd998f54449579b446817afbd17273e6"
+		"62c97ee72995ef42640c550b9013fad0761353c7086a272c24088be94769fd16"
+		"650",
+		"16748960b1203c22d128c999d75f349909e5f21092932df25ad16dc33307c482"
+		"65a6c49686a17d2205b3627fc9530d16899bdb0511925535aad952622a2d2d4b"
+		"b",
+		"2f96bbb2e0f1e70774fc79577cd1fdfc1e3dc6e37296320174400e8ab79622d7"
+		"906397485842a4998424ba4773293cb221f488c7e764d917d762108e19650dda"
+		"c0",
+		"1a467397c40f13058c2b37073424563915c02cc0629f0dc5c7c51610014de188"
+		"4e142aa106e3ffcccbe4dbb2d633bee08839397afcca465b558a05ec67b3e15b"
+		"6e9",
+		"16c997ce6c5b14c9238875d8994f7b86bd132983b13cab9012c0cea408ac5500"
+		"c0a5ff30cf7d9dd09e00a8f6ebab8ab0a20884f39a2c0e2b283d24f4511c1202"
+		"8",
+		"2b53b5f14868cd277eafa663d0fb6e34d1f188e40ebf7b6f7139d0da7b94c216"
+		"a76491b98136113a9c80eef27e7fafddcdffb0ef6f80f2097268918e8f40cd95",
+		"1efcd7e6e4f8cffe176d44167a750e7a6fd680372763e7d79731f4f2ef98ef30"
+		"5b1332ca1ee91fb150782f7f0c73e69de64f7ab7c9f0c509c2d87441ef09d0e0"
+		"8df",
+		"3f702b1743240d9ea52fa31002fc8bb4eceff330d913a02bd8eda4fe0218de65"
+		"a4689187189844a648f57d6b75abc8d001e52bd424200773d6bec611ad031157"
+		"8c",
+	},
+};
+
+#define EC_LEN  ((521 + MP_DIGIT_BITS - 1) / MP_DIGIT_BITS)
+
+static int ec_cmp (const struct mp_ec *c, const digit_t *p, const char *X,
+		   const char *Y)
+{
+	const size_t len = c->len;
+	digit_t x[EC_LEN], y[EC_LEN], ex[EC_LEN], ey[EC_LEN];
+
+	if (!mp_ec_pull (c, x, y, p))
+		return 0;
+
+	mp_show ("\tx  = ", x, len);
+	mp_show ("\ty  = ", y, len);
+
+	mp_load_zx (ex, len, X);
+	mp_load_zx (ey, len, Y);
+
+	return	mp_cmp_n (x, ex, len) == 0 && mp_cmp_n (y, ey, len) == 0 &&
+		mp_ec_check (c, x, y);
+}
+
+static int do_ec_test (const struct ec_sample *o)
+{
+	struct mp_ec c;
+	digit_t p[EC_LEN], a[EC_LEN], b[EC_LEN], x[EC_LEN], y[EC_LEN];
+	digit_t k[EC_LEN], u[EC_LEN], G[EC_LEN * 3], R[EC_LEN * 3];
+	digit_t S[EC_LEN * 3];
+	size_t len = mp_load_hex (p, ARRAY_SIZE (p), o->P);
+	int ok;
+
+	printf ("ec test:\n");
+
+	mp_load_zx (a, len, o->A);
+	mp_load_zx (b, len, o->B);
+	mp_load_zx (x, len, o->Gx);
+	mp_load_zx (y, len, o->Gy);
+
+	if (!mp_ec_init (&c, p, len, a, b)) {
+		printf ("\tcannot initialize curve\n");
+		return 0;
+	}
+
+	ok = mp_ec_check (&c, x, y);
+	mp_ec_push (&c, G, x, y);
+
+	mp_load_zx (k, len, o->K);
+	mp_ec_mul_sec (&c, R, G, k);
+	ok &= ec_cmp (&c, R, o->Rx, o->Ry);
+
+	mp_load_zx (k, len, o->U);
+	mp_load_zx (u, len, o->V);
+	ok &= mp_ec_mul2 (&c, S, k, G, u, R);
+	ok &= ec_cmp (&c, S, o->Sx, o->Sy);
+
+	/* complete formulas: G + G = 2 G, G - G = O, O + O = O */
+	mp_ec_add (&c, R, G, G);
+	mp_ec_dbl (&c, S, G);
+	ok &= mp_ec_pull (&c, x, y, R) && mp_ec_pull (&c, a, b, S) &&
+	      mp_cmp_n (x, a, len) == 0 && mp_cmp_n (y, b, len) == 0;
+
+	mp_ec_neg (&c, R, G);
+	mp_ec_add (&c, R, R, G);
+	ok &= !mp_ec_pull (&c, x, y, R);
+
+	mp_ec_dbl (&c, R, R);
+	mp_ec_add (&c, R, R, R);
+	ok &= !mp_ec_pull (&c, x, y, R);
+
+	mp_zero (k, len);
+	mp_ec_mul_sec (&c, R, G, k);
+	ok &= !mp_ec_pull (&c, x, y, R);
+
+	mp_ec_fini (&c);
+
+	printf ("\t%s\n", ok ? "passed" : "failed");
+	return ok;
+}
+
+static int do_ec_tests (void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (ec_sample); ++i)
+		if (!do_ec_test (ec_sample + i))
+			return 0;
+
+	return 1;
+}
+
 int main (int argc, char *argv[])
 {
 	return	do_mu_tests () && do_pull_tests () && do_ro_tests () &&
-		do_push_tests () && do_pow_tests () ? 0 : 1;
+		do_push_tests () && do_sqr_tests () && do_inv_tests () &&
+		do_inv_batch_tests () && do_pow_tests () &&
+		do_fallback_tests () && do_pow_multi_tests () &&
+		do_comb_tests () &&
+		do_ctx_tests () && do_rsa_tests () && do_ec_tests () ? 0 : 1;
 }
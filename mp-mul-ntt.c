@@ -0,0 +1,365 @@
+/*
+ * MP Core Multiplication: Three-Prime Number-Theoretic Transform
+ *
+ * Copyright (c) 2018-2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/digit.h>
+#include <mp/mont-mul.h>
+#include <mp/mul.h>
+#include <mp/unit.h>
+
+/*
+ * Each digit of the operands is a coefficient of a polynomial, the
+ * product of polynomials is computed modulo three primes of the form
+ * c * 2^k + 1, and then the coefficients are recovered with the Garner
+ * algorithm. Every coefficient of the product is less than ylen * B^2,
+ * and the product of primes is greater than 2^order * B^2, thus the
+ * recovery is exact.
+ *
+ * All the primes are less than B / 2, which is required for our
+ * Montgomery reduction, see mp_ntt_mul below.
+ */
+struct mp_ntt_prime {
+	digit_t p, g;		/* prime and its primitive root		*/
+};
+
+#if MP_DIGIT_BITS == 64
+
+#define MP_NTT_ORDER  55
+
+static const struct mp_ntt_prime mp_ntt_prime[3] = {
+	{ 0x3a00000000000001, 3 },	/* 29 * 2^57 + 1 */
+	{ 0x2280000000000001, 5 },	/* 69 * 2^55 + 1 */
+	{ 0x1b00000000000001, 5 },	/* 27 * 2^56 + 1 */
+};
+
+#elif MP_DIGIT_BITS == 32
+
+#define MP_NTT_ORDER  21
+
+static const struct mp_ntt_prime mp_ntt_prime[3] = {
+	{ 0x3b800001, 3 },		/* 119 * 2^23 + 1 */
+	{ 0x0a000001, 3 },		/*   5 * 2^25 + 1 */
+	{ 0x1c000001, 3 },		/*   7 * 2^26 + 1 */
+};
+
+#else
+#error "NTT primes are not defined for this digit size"
+#endif
+
+/*
+ * Residue field context: all the values are kept in Montgomery form,
+ * x R mod p, where R = B
+ */
+struct mp_ntt {
+	digit_t p, mu, r2;	/* prime, -p^-1 mod B and R^2 mod p	*/
+};
+
+static void mp_ntt_init (struct mp_ntt *o, digit_t p)
+{
+	digit_t q, r;
+
+	mp_digit_div (&q, &r, 1, 0, p);	/* R   mod p */
+	mp_digit_div (&q, &r, r, 0, p);	/* R^2 mod p */
+
+	o->p  = p;
+	o->mu = mp_mont_mu (p);
+	o->r2 = r;
+}
+
+/*
+ * Function mp_ntt_mul computes x y / R mod p. Constraint: x y < p B,
+ * which holds when y < p for any x.
+ */
+static inline digit_t mp_ntt_mul (digit_t x, digit_t y, const struct mp_ntt *o)
+{
+	digit_t h, l, mh, ml;
+
+	mp_digit_mul (&h,  &l,  x, y);
+	mp_digit_mul (&mh, &ml, l * o->mu, o->p);
+
+	h += mh + (l != 0);  /* l + ml = 0 mod B, p < B / 2: no overflow */
+	return h >= o->p ? h - o->p : h;
+}
+
+static inline digit_t mp_ntt_add (digit_t x, digit_t y, const struct mp_ntt *o)
+{
+	x += y;
+	return x >= o->p ? x - o->p : x;
+}
+
+static inline digit_t mp_ntt_sub (digit_t x, digit_t y, const struct mp_ntt *o)
+{
+	return x >= y ? x - y : x + (o->p - y);
+}
+
+static inline digit_t mp_ntt_push (digit_t x, const struct mp_ntt *o)
+{
+	return mp_ntt_mul (x, o->r2, o);
+}
+
+static digit_t mp_ntt_pow (digit_t x, digit_t e, const struct mp_ntt *o)
+{
+	digit_t r = mp_ntt_push (1, o);
+
+	for (; e > 0; e >>= 1, x = mp_ntt_mul (x, x, o))
+		if ((e & 1) != 0)
+			r = mp_ntt_mul (r, x, o);
+
+	return r;
+}
+
+/*
+ * Function mp_ntt_roots fills (w, n / 2) with powers of primitive root
+ * of unity of order n, where n = 2^order, in Montgomery form.
+ */
+static void mp_ntt_roots (digit_t *w, int order, digit_t g,
+			  const struct mp_ntt *o)
+{
+	const size_t half = (size_t) 1 << (order - 1);
+	size_t i;
+
+	w[0] = mp_ntt_push (1, o);
+
+	if (half > 1)
+		w[1] = mp_ntt_pow (mp_ntt_push (g, o), (o->p - 1) >> order, o);
+
+	for (i = 2; i < half; ++i)
+		w[i] = mp_ntt_mul (w[i - 1], w[1], o);
+}
+
+/*
+ * Function mp_ntt_dif performs the forward Gentleman-Sande transform of
+ * (a, 2^order), the result is in bit-reversed order. Function mp_ntt_dit
+ * performs the inverse Cooley-Tukey transform of bit-reversed (a, 2^order)
+ * with roots (w, 2^order / 2), the result is in natural order scaled by
+ * 2^order.
+ */
+static void mp_ntt_dif (digit_t *a, int order, const digit_t *w,
+			const struct mp_ntt *o)
+{
+	const size_t n = (size_t) 1 << order;
+	size_t len, step, s, j;
+	digit_t u, v;
+
+	for (len = n / 2, step = 1; len > 0; len /= 2, step *= 2)
+		for (s = 0; s < n; s += len * 2)
+			for (j = 0; j < len; ++j) {
+				u = a[s + j];
+				v = a[s + j + len];
+
+				a[s + j]       = mp_ntt_add (u, v, o);
+				a[s + j + len] = mp_ntt_mul (mp_ntt_sub (u, v, o),
+							     w[j * step], o);
+			}
+}
+
+static void mp_ntt_dit (digit_t *a, int order, const digit_t *w,
+			const struct mp_ntt *o)
+{
+	const size_t n = (size_t) 1 << order;
+	size_t len, step, s, j;
+	digit_t u, v;
+
+	for (len = 1, step = n / 2; len < n; len *= 2, step /= 2)
+		for (s = 0; s < n; s += len * 2)
+			for (j = 0; j < len; ++j) {
+				u = a[s + j];
+				v = mp_ntt_mul (a[s + j + len], w[j * step], o);
+
+				a[s + j]       = mp_ntt_add (u, v, o);
+				a[s + j + len] = mp_ntt_sub (u, v, o);
+			}
+}
+
+/*
+ * Function mp_ntt_conv computes the cyclic convolution of (x, xlen) and
+ * (y, ylen) modulo p, and stores it into (z, 2^order) scaled by
+ * 2^order / R. Workspace: (t, 2^order) and (w, 2^order).
+ */
+static void mp_ntt_conv (digit_t *z, const digit_t *x, size_t xlen,
+			 const digit_t *y, size_t ylen, int order,
+			 const struct mp_ntt_prime *prime,
+			 digit_t *t, digit_t *w)
+{
+	const size_t n = (size_t) 1 << order, half = n / 2;
+	struct mp_ntt o;
+	digit_t r1;
+	size_t i;
+
+	mp_ntt_init (&o, prime->p);
+	r1 = mp_ntt_push (1, &o);  /* R mod p: x r1 / R = x mod p */
+
+	/* forward roots in (w, n/2), inverse roots in (w + n/2, n/2) */
+	mp_ntt_roots (w, order, prime->g, &o);
+
+	for (w[half] = w[0], i = 1; i < half; ++i)
+		w[half + i] = o.p - w[half - i];  /* w^-i = -w^(n/2 - i) */
+
+	for (i = 0; i < xlen; ++i)
+		z[i] = mp_ntt_mul (x[i], r1, &o);
+
+	mp_zero (z + xlen, n - xlen);
+	mp_ntt_dif (z, order, w, &o);
+
+	if (x == y && xlen == ylen)  /* squaring: one transform is enough */
+		t = z;
+	else {
+		for (i = 0; i < ylen; ++i)
+			t[i] = mp_ntt_mul (y[i], r1, &o);
+
+		mp_zero (t + ylen, n - ylen);
+		mp_ntt_dif (t, order, w, &o);
+	}
+
+	for (i = 0; i < n; ++i)
+		z[i] = mp_ntt_mul (z[i], t[i], &o);
+
+	mp_ntt_dit (z, order, w + half, &o);
+}
+
+/*
+ * Function mp_ntt_scale returns u 2^-order R mod p in Montgomery form,
+ * thus mp_ntt_mul (z, scale) = c u for z = c 2^order / R.
+ */
+static digit_t mp_ntt_scale (digit_t u, int order, const struct mp_ntt *o)
+{
+	digit_t s = mp_ntt_push (u, o);
+	int i;
+
+	for (i = 0; i < order; ++i)  /* s = s / 2 mod p */
+		s = (s & 1) == 0 ? s >> 1 : (s >> 1) + (o->p >> 1) + 1;
+
+	return mp_ntt_push (s, o);
+}
+
+/*
+ * Function mp_ntt_inv returns x^-1 mod p in regular form
+ */
+static digit_t mp_ntt_inv (digit_t x, const struct mp_ntt *o)
+{
+	digit_t y = mp_ntt_pow (mp_ntt_push (x, o), o->p - 2, o);
+
+	return mp_ntt_mul (y, 1, o);
+}
+
+/*
+ * Function mp_ntt_garner recovers the product coefficients from the
+ * residues (z[0..2], 2^order) and stores them into (r, len).
+ */
+static void mp_ntt_garner (digit_t *r, size_t len, digit_t *const z[3],
+			   int order)
+{
+	const digit_t p1 = mp_ntt_prime[0].p, p2 = mp_ntt_prime[1].p;
+	struct mp_ntt o1, o2, o3;
+	digit_t k1, k2, u2, k3, u3, v3, p12[2], c[3], v[3], t[3];
+	digit_t x1, x2, x3;
+	size_t i;
+
+	mp_ntt_init (&o1, p1);
+	mp_ntt_init (&o2, p2);
+	mp_ntt_init (&o3, mp_ntt_prime[2].p);
+
+	/*
+	 * x1 = c mod p1
+	 * x2 = (c - x1) / p1 mod p2
+	 * x3 = (c - x1 - x2 p1) / (p1 p2) mod p3
+	 * c  = x1 + x2 p1 + x3 p1 p2
+	 *
+	 * The k_i constants remove the transform scale along the way.
+	 */
+	mp_digit_mul (p12 + 1, p12 + 0, p1, p2);
+
+	k1 = mp_ntt_scale (1, order, &o1);
+
+	u2 = mp_ntt_inv (p1, &o2);
+	k2 = mp_ntt_scale (u2, order, &o2);
+	u2 = mp_ntt_push (u2, &o2);
+
+	u3 = mp_ntt_inv (mp_ntt_mul (mp_ntt_push (p1, &o3), p2, &o3), &o3);
+	k3 = mp_ntt_scale (u3, order, &o3);
+	v3 = mp_ntt_push (mp_ntt_mul (mp_ntt_push (p1, &o3), u3, &o3), &o3);
+	u3 = mp_ntt_push (u3, &o3);
+
+	mp_zero (c, 3);
+
+	for (i = 0; i < len; ++i) {
+		x1 = mp_ntt_mul (z[0][i], k1, &o1);
+
+		x2 = mp_ntt_sub (mp_ntt_mul (z[1][i], k2, &o2),
+				 mp_ntt_mul (x1, u2, &o2), &o2);
+
+		x3 = mp_ntt_sub (mp_ntt_mul (z[2][i], k3, &o3),
+				 mp_ntt_mul (x1, u3, &o3), &o3);
+		x3 = mp_ntt_sub (x3, mp_ntt_mul (x2, v3, &o3), &o3);
+
+		/* v = x1 + x2 p1 + x3 p1 p2 < p1 p2 p3 < B^3 */
+		mp_digit_fma (v + 1, v + 0, x2, p1, x1);
+		v[2] = 0;
+		t[2] = mp_mul_1 (t, p12, 2, x3);
+		mp_add_n (v, v, t, 3, 0);
+
+		/* c < B^2 here, thus c + v < B^3 */
+		mp_add_n (c, c, v, 3, 0);
+
+		r[i] = c[0];
+		c[0] = c[1];
+		c[1] = c[2];
+		c[2] = 0;
+	}
+}
+
+static int mp_ntt_order (size_t xlen, size_t ylen)
+{
+	int order;
+
+	for (order = 1; ((size_t) 1 << order) < xlen + ylen; ++order) {}
+
+	return order;
+}
+
+/*
+ * Function mp_mul_ntt_itch returns the size of workspace for mp_mul_ntt_ws
+ * or zero if the operands are too long for the transform.
+ */
+size_t mp_mul_ntt_itch (size_t xlen, size_t ylen)
+{
+	const int order = mp_ntt_order (xlen, ylen);
+
+	return order > MP_NTT_ORDER ? 0 : ((size_t) 1 << order) * 5;
+}
+
+void mp_mul_ntt_ws (digit_t *r, const digit_t *x, size_t xlen,
+				const digit_t *y, size_t ylen, digit_t *ws)
+{
+	const int order = mp_ntt_order (xlen, ylen);
+	const size_t n = (size_t) 1 << order;
+	digit_t *const z[3] = { ws, ws + n, ws + n * 2 };
+	digit_t *t = ws + n * 3, *w = ws + n * 4;
+	int i;
+
+	for (i = 0; i < 3; ++i)
+		mp_ntt_conv (z[i], x, xlen, y, ylen, order, mp_ntt_prime + i,
+			     t, w);
+
+	mp_ntt_garner (r, xlen + ylen, z, order);
+}
+
+int mp_mul_ntt (digit_t *r, const digit_t *x, size_t xlen,
+			    const digit_t *y, size_t ylen)
+{
+	const size_t len = mp_mul_ntt_itch (xlen, ylen);
+	digit_t *ws;
+
+	if (len == 0 || (ws = mp_alloc (len)) == NULL)
+		return 0;
+
+	mp_mul_ntt_ws (r, x, xlen, y, ylen, ws);
+	mp_free (ws);
+	return 1;
+}
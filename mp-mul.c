@@ -7,7 +7,12 @@
  */
 
 #include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/digit.h>
+#include <mp/div.h>
 #include <mp/mul.h>
+#include <mp/shift.h>
+#include <mp/unit.h>
 
 /*
  * Constraint for all mp_mul: xlen >= ylen > 0
@@ -28,10 +33,13 @@ void mp_mul_sb (digit_t *r, const digit_t *x, size_t xlen,
 
 /*
  * Constraint: xlen >= ylen > 4 to prevent overflow
+ *
+ * Workspace: (ws, 2 (alen + clen + 2)) for own needs, where the rest of
+ * workspace is used by recursive calls.
  */
 static
 void mp_mul_kara (digit_t *r, const digit_t *x, size_t xlen,
-			      const digit_t *y, size_t ylen)
+			      const digit_t *y, size_t ylen, digit_t *ws)
 {
 	const size_t blen = ylen / 2, alen = xlen - blen;
 	const size_t dlen = ylen / 2, clen = ylen - dlen;
@@ -39,36 +47,373 @@ void mp_mul_kara (digit_t *r, const digit_t *x, size_t xlen,
 	const digit_t *a = x + blen, *b = x, *c = y + dlen, *d = y;
 
 	digit_t *ac = r + blen + dlen, *bd = r;
+	digit_t *apb = ws, *cpd = apb + alen + 1, *m = cpd + clen + 1;
+
+	mp_mul_ws (bd, b, blen, d, dlen, ws);
+	mp_mul_ws (ac, a, alen, c, clen, ws);
+
+	apb[alen] = mp_add (apb, a, alen, b, blen, 0);
+	cpd[clen] = mp_add (cpd, c, clen, d, dlen, 0);
+
+	mp_mul_ws (m, apb, alen + 1, cpd, clen + 1, m + alen + clen + 2);
+
+	/* ignore carry, it evaluates to zero always */
+	mp_sub (m, m, alen + clen + 1, ac, alen + clen, 0);
+	mp_sub (m, m, alen + clen + 1, bd, blen + dlen, 0);
+
+	/* Note that the most significant digit of m is always zero */
+	mp_add (r + dlen, r + dlen, xlen + clen, m, alen + clen + 1, 0);
+}
+
+#define MP_TOOM3_CUTOFF  120
 
-	mp_mul (bd, b, blen, d, dlen);
-	mp_mul (ac, a, alen, c, clen);
+/*
+ * Function mp_toom3_cneg negates (x, len) in two's complement form if mask
+ * is all ones, and leaves it intact if mask is zero, without branches.
+ */
+static void mp_toom3_cneg (digit_t *x, size_t len, digit_t mask)
+{
+	size_t i;
 
-	{
-		/*
-		 * do not move it up to prevent O(n log n) memory usage where
-		 * O(n) is enough
-		 */
-		digit_t apb[alen + 1], cpd[clen + 1], m[alen + clen + 2];
+	for (i = 0; i < len; ++i)
+		x[i] ^= mask;
 
-		apb[alen] = mp_add (apb, a, alen, b, blen, 0);
-		cpd[clen] = mp_add (cpd, c, clen, d, dlen, 0);
+	mp_add_1 (x, x, len, mask & 1);
+}
 
-		mp_mul (m, apb, alen + 1, cpd, clen + 1);
+/*
+ * Function mp_toom3_eval evaluates polynomial x2 t^2 + x1 t + x0 at points
+ * t = 1, t = -1 and t = 2, where the length of x0 and x1 is k and the
+ * length of x2 is x2len. Results stored into (p1, k + 1), (pm1, k + 1)
+ * and (p2, k + 1). The function returns all ones mask if p(-1) is
+ * negative, or zero otherwise, and the absolute value of p(-1) is stored
+ * into pm1. The sign is applied with masks, thus the control flow does not
+ * depend on data.
+ */
+static digit_t mp_toom3_eval (digit_t *p1, digit_t *pm1, digit_t *p2,
+			      const digit_t *x, size_t k, size_t x2len)
+{
+	const digit_t *x0 = x, *x1 = x + k, *x2 = x + k * 2;
+	digit_t neg;
 
-		/* ignore carry, it evaluates to zero always */
-		mp_sub (m, m, alen + clen + 1, ac, alen + clen, 0);
-		mp_sub (m, m, alen + clen + 1, bd, blen + dlen, 0);
+	/* p2 = x0 + 2 (x1 + 2 x2) */
+	p2[k]  = mp_add (p2, x1, k, x2, x2len, 0);
+	p2[k] += mp_add (p2, p2, k, x2, x2len, 0);
+	mp_lshift (p2, p2, k + 1, 0, 1);
+	p2[k] += mp_add_n (p2, p2, x0, k, 0);
 
-		/* Note that the most significant digit of m is always zero */
-		mp_add (r + dlen, r + dlen, xlen + clen, m, alen + clen + 1, 0);
+	/* p1 = (x0 + x2) + x1 */
+	p1[k] = mp_add (p1, x0, k, x2, x2len, 0);
+
+	/* pm1 = |(x0 + x2) - x1|, where x0 + x2 - x1 > -B^k */
+	pm1[k] = p1[k] - mp_sub_n (pm1, p1, x1, k, 0);
+	neg = 0 - (pm1[k] >> (MP_DIGIT_BITS - 1));
+	mp_toom3_cneg (pm1, k + 1, neg);
+
+	p1[k] += mp_add_n (p1, p1, x1, k, 0);
+	return neg;
+}
+
+/*
+ * Function mp_toom3_join interpolates the product polynomial from its
+ * values and stores the product into (r, len), where v(0) is already
+ * stored into (r, 2 k), v(inf) is already stored into (r + 4 k, ilen),
+ * v(1), v(-1) and v(2) are in (v1, w), (vm1, w) and (v2, w), and
+ * w = 2 k + 2. Note that v(-1) is in two's complement form.
+ *
+ * The interpolation sequence is selected such that all intermediate
+ * values are non-negative except of v(-1), where c_i are the coefficients
+ * of the product polynomial:
+ *
+ * v2  = (v2 - vm1) / 3		= c1 + c2 + 3 c3 + 5 c4
+ * vm1 = (v1 - vm1) / 2		= c1 + c3
+ * v1  = v1 - v0		= c1 + c2 + c3 + c4
+ * v2  = (v2 - v1) / 2		= c3 + 2 c4
+ * v1  = v1 - vm1 - vinf	= c2
+ * v2  = v2 - 2 vinf		= c3
+ * vm1 = vm1 - v2		= c1
+ */
+static void mp_toom3_join (digit_t *r, size_t len, size_t k, size_t ilen,
+			   digit_t *v1, digit_t *vm1, digit_t *v2)
+{
+	const size_t w = k * 2 + 2;
+	const digit_t *v0 = r, *vinf = r + k * 4;
+
+	mp_sub_n (v2, v2, vm1, w, 0);
+	mp_divexact_by3 (v2, v2, w);
+	mp_sub_n (vm1, v1, vm1, w, 0);
+	mp_rshift (vm1, vm1, w, 0, 1);
+	mp_sub (v1, v1, w, v0, k * 2, 0);
+	mp_sub_n (v2, v2, v1, w, 0);
+	mp_rshift (v2, v2, w, 0, 1);
+	mp_sub_n (v1, v1, vm1, w, 0);
+	mp_sub (v1, v1, w, vinf, ilen, 0);
+	mp_sub (v2, v2, w, vinf, ilen, 0);
+	mp_sub (v2, v2, w, vinf, ilen, 0);
+	mp_sub_n (vm1, vm1, v2, w, 0);
+
+	/*
+	 * Recomposition. Note that the result fits into (r, len), thus
+	 * the high digits of c3 beyond it are always zero, and carries
+	 * are always zero too.
+	 */
+	mp_zero (r + k * 2, k * 2);
+	mp_add (r + k,     r + k,     len - k,     vm1, w, 0);
+	mp_add (r + k * 2, r + k * 2, len - k * 2, v1,  w, 0);
+	mp_add (r + k * 3, r + k * 3, len - k * 3, v2,
+		w < len - k * 3 ? w : len - k * 3, 0);
+}
+
+/*
+ * Function mp_mul_toom3 multiplies (x, xlen) by (y, ylen) using Toom-Cook
+ * 3-way algorithm with evaluation points 0, 1, -1, 2 and infinity.
+ *
+ * Constraint: xlen >= ylen > 2 * ceil (xlen / 3).
+ *
+ * Workspace: (ws, 12 (k + 1)) for own needs, where the rest of workspace
+ * is used by recursive calls.
+ */
+static
+void mp_mul_toom3 (digit_t *r, const digit_t *x, size_t xlen,
+			       const digit_t *y, size_t ylen, digit_t *ws)
+{
+	const size_t k = (xlen + 2) / 3, n = k + 1, w = n * 2;
+	const size_t x2len = xlen - k * 2, y2len = ylen - k * 2;
+
+	digit_t *px1 = ws,	 *pxm1 = px1 + n, *px2 = pxm1 + n;
+	digit_t *py1 = px2 + n,  *pym1 = py1 + n, *py2 = pym1 + n;
+	digit_t *v1  = py2 + n,  *vm1  = v1  + w, *v2  = vm1  + w;
+	digit_t neg;
+
+	mp_mul_ws (r,         x, k, y, k, ws);
+	mp_mul_ws (r + k * 4, x + k * 2, x2len, y + k * 2, y2len, ws);
+
+	neg  = mp_toom3_eval (px1, pxm1, px2, x, k, x2len);
+	neg ^= mp_toom3_eval (py1, pym1, py2, y, k, y2len);
+
+	ws = v2 + w;
+
+	mp_mul_ws (v1,  px1,  n, py1,  n, ws);
+	mp_mul_ws (vm1, pxm1, n, pym1, n, ws);
+	mp_mul_ws (v2,  px2,  n, py2,  n, ws);
+
+	mp_toom3_cneg (vm1, w, neg);
+
+	mp_toom3_join (r, xlen + ylen, k, x2len + y2len, v1, vm1, v2);
+}
+
+/*
+ * Function mp_mul_chunk multiplies (x, xlen) by (y, ylen) by chunks of
+ * ylen digits of x, thus the faster algorithms work with balanced
+ * operands only.
+ *
+ * Constraint: xlen >= 2 ylen > 0.
+ *
+ * Workspace: (ws, 2 ylen) for own needs, where the rest of workspace is
+ * used by recursive calls.
+ */
+static
+void mp_mul_chunk (digit_t *r, const digit_t *x, size_t xlen,
+			       const digit_t *y, size_t ylen, digit_t *ws)
+{
+	digit_t *t = ws;
+	size_t i, n;
+	char c;
+
+	mp_mul_ws (r, x, ylen, y, ylen, ws);
+
+	for (ws += ylen * 2, i = ylen; i < xlen; i += n) {
+		n = xlen - i < ylen ? xlen - i : ylen;
+
+		if (n == ylen)
+			mp_mul_ws (t, x + i, n, y, ylen, ws);
+		else
+			mp_mul_ws (t, y, ylen, x + i, n, ws);
+
+		mp_copy (r + i + ylen, t + ylen, n);
+
+		c = mp_add_n (r + i, r + i, t, ylen, 0);
+		mp_add_1 (r + i + ylen, r + i + ylen, n, c);
 	}
 }
 
+/*
+ * The workspace bound is derived as follows. Each algorithm uses no more
+ * than c n digits for its own needs, where n = xlen + ylen, and the
+ * largest recursive call works on operands of the total size n' <= 2/3 n
+ * + 2. Given that Karatsuba and Toom-3 work on balanced operands only,
+ * S (n) = 10 n holds for all the algorithms (and for NTT as well, as its
+ * transform length is less than 2 n).
+ */
+size_t mp_mul_itch (size_t xlen, size_t ylen)
+{
+	return ylen < MP_KARATSUBA_CUTOFF ? 0 : (xlen + ylen) * 10;
+}
+
+void mp_mul_ws (digit_t *r, const digit_t *x, size_t xlen,
+			    const digit_t *y, size_t ylen, digit_t *ws)
+{
+	if (x == y && xlen == ylen)
+		mp_sqr_ws (r, x, xlen, ws);
+	else if (ylen < MP_KARATSUBA_CUTOFF)
+		mp_mul_sb (r, x, xlen, y, ylen);
+	else if (xlen >= ylen * 2)
+		mp_mul_chunk (r, x, xlen, y, ylen, ws);
+	else if (ylen >= MP_NTT_CUTOFF && mp_mul_ntt_itch (xlen, ylen) > 0)
+		mp_mul_ntt_ws (r, x, xlen, y, ylen, ws);
+	else if (ylen < MP_TOOM3_CUTOFF || ylen <= (xlen + 2) / 3 * 2)
+		mp_mul_kara (r, x, xlen, y, ylen, ws);
+	else
+		mp_mul_toom3 (r, x, xlen, y, ylen, ws);
+}
+
+/*
+ * If there is no memory for the workspace, fall back to the school book
+ * algorithm, which does not need it.
+ */
 void mp_mul (digit_t *r, const digit_t *x, size_t xlen,
 			 const digit_t *y, size_t ylen)
 {
-	if (ylen < MP_KARATSUBA_CUTOFF)
+	const size_t len = mp_mul_itch (xlen, ylen);
+	digit_t *ws;
+
+	if (len == 0)
+		mp_mul_ws (r, x, xlen, y, ylen, NULL);
+	else if ((ws = mp_alloc (len)) == NULL)
 		mp_mul_sb (r, x, xlen, y, ylen);
+	else {
+		mp_mul_ws (r, x, xlen, y, ylen, ws);
+		mp_free (ws);
+	}
+}
+
+/*
+ * Constraint for all mp_sqr: len > 0
+ */
+void mp_sqr_sb (digit_t *r, const digit_t *x, size_t len)
+{
+	size_t i;
+	int c;
+	digit_t h, l;
+
+	/* cross products x_i x_j, where i < j */
+	r[0] = 0;
+	r[len] = mp_mul_1 (r + 1, x + 1, len - 1, x[0]);
+
+	for (i = 1; i + 1 < len; ++i)
+		r[i + len] = mp_addmul_1 (r + i * 2 + 1, x + i + 1, len - i - 1,
+					  x[i], 0);
+
+	/* double them, then add squares x_i^2 */
+	r[len * 2 - 1] = 0;
+	mp_lshift (r, r, len * 2, 0, 1);
+
+	for (i = 0, c = 0; i < len; ++i) {
+		mp_digit_mul (&h, &l, x[i], x[i]);
+
+		c = mp_digit_adc (r + i * 2,     r[i * 2],     l, c);
+		c = mp_digit_adc (r + i * 2 + 1, r[i * 2 + 1], h, c);
+	}
+}
+
+#define MP_KARATSUBA_SQR_CUTOFF  30
+
+/*
+ * Constraint: len > 4 to prevent overflow
+ *
+ * Note that the (a + b)^2 form is used instead of (a - b)^2 one to keep
+ * the control flow independent of data.
+ *
+ * Workspace: (ws, 3 (alen + 1)) for own needs, where the rest of
+ * workspace is used by recursive calls.
+ */
+static void mp_sqr_kara (digit_t *r, const digit_t *x, size_t len,
+			 digit_t *ws)
+{
+	const size_t blen = len / 2, alen = len - blen;
+	const digit_t *a = x + blen, *b = x;
+
+	digit_t *aa = r + blen * 2, *bb = r;
+	digit_t *apb = ws, *m = apb + alen + 1;
+
+	mp_sqr_ws (bb, b, blen, ws);
+	mp_sqr_ws (aa, a, alen, ws);
+
+	apb[alen] = mp_add (apb, a, alen, b, blen, 0);
+
+	mp_sqr_ws (m, apb, alen + 1, m + alen * 2 + 2);
+
+	/* ignore carry, it evaluates to zero always */
+	mp_sub (m, m, alen * 2 + 1, aa, alen * 2, 0);
+	mp_sub (m, m, alen * 2 + 1, bb, blen * 2, 0);
+
+	/* Note that the most significant digit of m is always zero */
+	mp_add (r + blen, r + blen, len + alen, m, alen * 2 + 1, 0);
+}
+
+#define MP_TOOM3_SQR_CUTOFF  150
+
+/*
+ * Constraint: len > 6
+ *
+ * Workspace: (ws, 9 (k + 1)) for own needs, where the rest of workspace
+ * is used by recursive calls.
+ */
+static void mp_sqr_toom3 (digit_t *r, const digit_t *x, size_t len,
+			  digit_t *ws)
+{
+	const size_t k = (len + 2) / 3, n = k + 1, w = n * 2;
+	const size_t x2len = len - k * 2;
+
+	digit_t *p1 = ws, *pm1 = p1 + n, *p2 = pm1 + n;
+	digit_t *v1 = p2 + n, *vm1 = v1 + w, *v2 = vm1 + w;
+
+	mp_sqr_ws (r,         x, k, ws);
+	mp_sqr_ws (r + k * 4, x + k * 2, x2len, ws);
+
+	/* the sign of p(-1) does not matter for v(-1) = p(-1)^2 */
+	mp_toom3_eval (p1, pm1, p2, x, k, x2len);
+
+	ws = v2 + w;
+
+	mp_sqr_ws (v1,  p1,  n, ws);
+	mp_sqr_ws (vm1, pm1, n, ws);
+	mp_sqr_ws (v2,  p2,  n, ws);
+
+	mp_toom3_join (r, len * 2, k, x2len * 2, v1, vm1, v2);
+}
+
+/*
+ * See mp_mul_itch for the workspace bound.
+ */
+size_t mp_sqr_itch (size_t len)
+{
+	return len < MP_KARATSUBA_SQR_CUTOFF ? 0 : len * 20;
+}
+
+void mp_sqr_ws (digit_t *r, const digit_t *x, size_t len, digit_t *ws)
+{
+	if (len < MP_KARATSUBA_SQR_CUTOFF)
+		mp_sqr_sb (r, x, len);
+	else if (len >= MP_NTT_CUTOFF && mp_mul_ntt_itch (len, len) > 0)
+		mp_mul_ntt_ws (r, x, len, x, len, ws);
+	else if (len < MP_TOOM3_SQR_CUTOFF)
+		mp_sqr_kara (r, x, len, ws);
 	else
-		mp_mul_kara (r, x, xlen, y, ylen);
+		mp_sqr_toom3 (r, x, len, ws);
+}
+
+void mp_sqr (digit_t *r, const digit_t *x, size_t len)
+{
+	const size_t n = mp_sqr_itch (len);
+	digit_t *ws;
+
+	if (n == 0)
+		mp_sqr_sb (r, x, len);
+	else if ((ws = mp_alloc (n)) == NULL)
+		mp_sqr_sb (r, x, len);
+	else {
+		mp_sqr_ws (r, x, len, ws);
+		mp_free (ws);
+	}
 }
@@ -0,0 +1,185 @@
+/*
+ * MP Core RSA Private Operation with Chinese Remainder Theorem
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/alloc.h>
+#include <mp/core.h>
+#include <mp/digit.h>
+#include <mp/div.h>
+#include <mp/mod.h>
+#include <mp/rsa.h>
+#include <mp/shift.h>
+#include <mp/unit.h>
+
+/*
+ * Function mp_rsa_mod computes (r, len) = (x, xlen) mod (m, len) using
+ * workspace (ws, xlen + len + 1). Constraints: xlen >= len, the most
+ * significant digit of M is not zero. Division takes variable time, thus
+ * it is used for key setup only.
+ */
+static void mp_rsa_mod (digit_t *r, const digit_t *x, size_t xlen,
+			const digit_t *m, size_t len, digit_t *ws)
+{
+	const int s = mp_digit_clz (m[len - 1]);
+	digit_t *a = ws, *b = a + xlen + 1;
+	size_t n;
+
+	if (s > 0) {
+		a[xlen] = mp_lshift (a, x, xlen, 0, s);
+		mp_lshift (b, m, len, 0, s);
+	}
+	else {
+		mp_copy (a, x, xlen);
+		mp_copy (b, m, len);
+		a[xlen] = 0;
+	}
+
+	if ((n = mp_normalize (a, xlen + 1)) >= len)
+		n = mp_normalize (a, mp_mod (a, a, n, b, len));
+
+	mp_zero (a + n, len - n);
+
+	if (s > 0)
+		mp_rshift (r, a, len, 0, s);
+	else
+		mp_copy (r, a, len);
+}
+
+/*
+ * Function mp_rsa_push converts X = (x, 2 len) = xh R + xl to Montgomery
+ * form X R = xl R + xh R^2 modulo M of context c with multiplications by
+ * ro = R^2 and r3 = R^3 modulo M, and stores result into (r, len) using
+ * (t, len) as a temporary. REDC result is less than 2 M if one operand is
+ * less than M and another one is less than R, thus neither xl nor xh needs
+ * to be reduced first, and no division by secret M takes place.
+ */
+static void mp_rsa_push (const struct mp_mont_ctx *c, digit_t *r,
+			 const digit_t *x, const digit_t *r3, digit_t *t)
+{
+	const size_t len = c->len;
+
+	mp_mont_mul (c, r, x, c->ro);
+	mp_mont_mul (c, t, x + len, r3);
+	mp_mod_add_n_sec (r, r, t, c->m, len);
+}
+
+static size_t mp_rsa_itch (size_t len)
+{
+	return len * 7 + 1;
+}
+
+int mp_rsa_init (struct mp_rsa *o, const digit_t *p, const digit_t *q,
+		 size_t len, const digit_t *d, const digit_t *e)
+{
+	const size_t nlen = len * 2;
+	digit_t *t, *u;
+
+	if (mp_cmp_n (p, q, len) < 0) {
+		const digit_t *s = p;
+
+		p = q, q = s;
+	}
+
+	if ((o->dp = mp_alloc (len * 5 + nlen + mp_rsa_itch (len))) == NULL)
+		return 0;
+
+	o->dq   = o->dp + len;
+	o->qinv = o->dq + len;
+	o->r3p  = o->qinv + len;
+	o->r3q  = o->r3p + len;
+	o->e    = o->r3q + len;
+	o->ws   = o->e + nlen;
+	o->len  = len;
+
+	if (!mp_mont_init (&o->p, p, len))
+		goto no_p;
+
+	if (!mp_mont_init (&o->q, q, len))
+		goto no_q;
+
+	/* R^3 = R^2 R^2 R^-1 modulo p and q */
+	mp_mont_mul (&o->p, o->r3p, o->p.ro, o->p.ro);
+	mp_mont_mul (&o->q, o->r3q, o->q.ro, o->q.ro);
+
+	/* dP = d mod (p - 1), dQ = d mod (q - 1), p and q are odd */
+	t = o->ws, u = t + len;
+
+	mp_copy (t, p, len), t[0] &= ~(digit_t) 1;
+	mp_rsa_mod (o->dp, d, nlen, t, len, u);
+	mp_copy (t, q, len), t[0] &= ~(digit_t) 1;
+	mp_rsa_mod (o->dq, d, nlen, t, len, u);
+
+	/* qInv R = (q R)^-1 R^2 mod p, q < p */
+	mp_mont_push (&o->p, t, q);
+
+	if (!mp_mont_inv (&o->p, o->qinv, t))
+		goto no_inv;
+
+	if (e == NULL) {
+		o->e = NULL;
+		return 1;
+	}
+
+	mp_copy (o->e, e, nlen);
+	mp_mul (t, p, len, q, len);
+
+	if (mp_mont_init (&o->n, t, mp_normalize (t, nlen)))
+		return 1;
+no_inv:
+	mp_mont_fini (&o->q);
+no_q:
+	mp_mont_fini (&o->p);
+no_p:
+	mp_free (o->dp);
+	return 0;
+}
+
+void mp_rsa_fini (struct mp_rsa *o)
+{
+	if (o->e != NULL)
+		mp_mont_fini (&o->n);
+
+	mp_mont_fini (&o->q);
+	mp_mont_fini (&o->p);
+	mp_free (o->dp);
+}
+
+int mp_rsa_crt (const struct mp_rsa *o, digit_t *r, const digit_t *x)
+{
+	const size_t len = o->len, nlen = len * 2;
+	digit_t *a = o->ws, *u = a + nlen + len + 1, *v = u + len;
+	digit_t *mp = v + len, *mq = mp + len;
+
+	/* mp = (x mod p)^dP mod p, mq = (x mod q)^dQ mod q */
+	mp_rsa_push (&o->p, v, x, o->r3p, u);
+	mp_mont_pow_sec (&o->p, u, v, o->dp);
+	mp_mont_pull (&o->p, mp, u);
+
+	mp_rsa_push (&o->q, v, x, o->r3q, u);
+	mp_mont_pow_sec (&o->q, u, v, o->dq);
+	mp_mont_pull (&o->q, mq, u);
+
+	/* Garner: h = qInv (mp - mq) mod p, R = mq + q h, mq < q < p */
+	mp_mod_sub_n_sec (u, mp, mq, o->p.m, len);
+	mp_mont_mul (&o->p, v, u, o->qinv);
+	mp_mul (r, o->q.m, len, v, len);
+	mp_add (r, r, nlen, mq, len, 0);
+
+	if (o->e == NULL)
+		return 1;
+
+	/* verify R^e = X mod N, R and X are less than N */
+	mp_mont_push (&o->n, a, r);
+	mp_mont_pow (&o->n, u, a, o->e);
+	mp_mont_pull (&o->n, a, u);
+
+	if (mp_cmp_n (a, x, o->n.len) == 0)
+		return 1;
+
+	mp_zero (r, nlen);
+	return 0;
+}
@@ -0,0 +1,375 @@
+/*
+ * MP Core Modular Arithmetics: Special Form Modulus Reduction
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <mp/add.h>
+#include <mp/alloc.h>
+#include <mp/core.h>
+#include <mp/digit.h>
+#include <mp/mul.h>
+#include <mp/solinas.h>
+#include <mp/unit.h>
+
+#define MP_CHUNK_BITS	32
+#define MP_CHUNK_MAX	32		/* chunks in Solinas modulus   */
+#define MP_COEFF_MAX	(1L << 16)	/* matrix coefficient bound    */
+#define MP_COLUMN_MAX	(1L << 24)	/* column sum of coefficients  */
+
+static inline uint32_t mp_chunk (const digit_t *x, size_t i)
+{
+#if MP_DIGIT_BITS == 64
+	return x[i / 2] >> (i % 2 * MP_CHUNK_BITS);
+#else
+	return x[i];
+#endif
+}
+
+/*
+ * Product needs (P, 2 len) and multiplication workspace, reduction needs
+ * (T, 2 len + 1) and (H, len + 1).
+ */
+static size_t mp_solinas_itch (size_t len)
+{
+	const size_t mul = mp_mul_itch (len, len), sqr = mp_sqr_itch (len);
+
+	return len * 5 + 2 + (mul > sqr ? mul : sqr);
+}
+
+/*
+ * Splits (c, n chunks) into balanced chunks b[i] in range (-2^31, 2^31],
+ * such that C = sum b[i] 2^(32 i). Returns zero if C needs more than n
+ * chunks or any chunk is not small.
+ */
+static int mp_solinas_balance (int64_t *b, const digit_t *c, size_t n)
+{
+	int64_t v, carry = 0;
+	size_t i;
+
+	for (i = 0; i < n; ++i) {
+		v = (int64_t) mp_chunk (c, i) + carry;
+		carry = v > ((int64_t) 1 << (MP_CHUNK_BITS - 1));
+		b[i] = v - (carry << MP_CHUNK_BITS);
+
+		if (b[i] > MP_COEFF_MAX || b[i] < -MP_COEFF_MAX)
+			return 0;
+	}
+
+	return carry == 0;
+}
+
+/*
+ * Row j of matrix is 2^(k + 32 j) mod M in balanced chunks: row 0 is C,
+ * row j + 1 is row j shifted by one chunk with the chunk shifted out at
+ * 2^k replaced by its multiple of C. Returns zero if coefficients grow
+ * too large to accumulate chunks in 64-bit integers.
+ */
+static int mp_solinas_row (int64_t *row, const int64_t *b, size_t n,
+			   size_t j)
+{
+	int64_t top;
+	size_t i, k;
+
+	for (i = 0; i < n; ++i)
+		row[i] = b[i];
+
+	for (k = 0; k < j; ++k) {
+		for (top = row[n - 1], i = n - 1; i > 0; --i)
+			row[i] = row[i - 1];
+
+		for (row[0] = 0, i = 0; i < n; ++i) {
+			row[i] += top * b[i];
+
+			if (row[i] > MP_COEFF_MAX || row[i] < -MP_COEFF_MAX)
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Reduction matrix layout: C (row 0) in n balanced chunks to fold carries,
+ * then for every column i the number of its non-zero entries followed by
+ * pairs (j, a) of row index and coefficient, thus every output chunk is
+ * accumulated at once.
+ */
+static int mp_solinas_matrix (struct mp_solinas *o, size_t n)
+{
+	int64_t b[n], row[n * n], sum;
+	int *p = o->t + n, *count;
+	size_t i, j;
+
+	if (!mp_solinas_balance (b, o->c, n))
+		return 0;
+
+	for (j = 0; j < n; ++j)
+		if (!mp_solinas_row (row + j * n, b, n, j))
+			return 0;
+
+	for (i = 0; i < n; ++i)
+		o->t[i] = b[i];
+
+	for (i = 0; i < n; ++i) {
+		for (count = p++, *count = 0, sum = 0, j = 0; j < n; ++j) {
+			if (row[j * n + i] == 0)
+				continue;
+
+			*p++ = j;
+			*p++ = row[j * n + i];
+			++*count;
+			sum += row[j * n + i] < 0 ? -row[j * n + i] :
+						    row[j * n + i];
+		}
+
+		if (sum > MP_COLUMN_MAX)
+			return 0;
+	}
+
+	return 1;
+}
+
+int mp_solinas_init (struct mp_solinas *o, const digit_t *m, size_t len)
+{
+	const size_t k = len * MP_DIGIT_BITS - mp_digit_clz (m[len - 1]);
+	const size_t n = k / MP_CHUNK_BITS, s = k % MP_DIGIT_BITS;
+	const size_t tsize = sizeof (o->t[0]) * (n * n + n) * 2;
+	size_t clen, cbits, tlen = 0;
+
+	if (k % MP_CHUNK_BITS == 0 && n <= MP_CHUNK_MAX)
+		tlen = (tsize + sizeof (digit_t) - 1) / sizeof (digit_t);
+
+	if ((o->m = mp_alloc (len * 2 + mp_solinas_itch (len) + tlen)) == NULL)
+		return 0;
+
+	o->c    = o->m + len;
+	o->ws   = o->c + len;
+	o->t    = NULL;
+	o->len  = len;
+	o->bits = k;
+
+	/* C = 2^k - M = -M mod 2^k */
+	mp_copy (o->m, m, len);
+	mp_neg (o->c, m, len);
+
+	if (s != 0)
+		o->c[len - 1] &= ((digit_t) 1 << s) - 1;
+
+	clen  = mp_normalize (o->c, len);
+	cbits = clen == 0 ? 0 : clen * MP_DIGIT_BITS -
+				mp_digit_clz (o->c[clen - 1]);
+
+	if (clen == 1 && cbits * 2 < k)
+		return 1;  /* pseudo-Mersenne */
+
+	if (tlen != 0) {
+		o->t = (void *) (o->ws + mp_solinas_itch (len));
+
+		if (mp_solinas_matrix (o, n))
+			return 1;
+	}
+
+	mp_free (o->m);
+	return 0;
+}
+
+void mp_solinas_fini (struct mp_solinas *o)
+{
+	mp_free (o->m);
+}
+
+/*
+ * Folds (T, tl) = H 2^k + L into L + H C using (h, tl - k / w) as H.
+ * Constraint: the result fits into (T, tl).
+ */
+static void mp_solinas_fold (const struct mp_solinas *o, digit_t *T,
+			     size_t tl, digit_t *h)
+{
+	const size_t kd = o->bits / MP_DIGIT_BITS, hl = tl - kd;
+	const int s = o->bits % MP_DIGIT_BITS;
+	const digit_t c = o->c[0];
+	digit_t hi, lo, carry;
+	size_t i;
+
+	if (s != 0) {
+		for (i = 0; i + 1 < hl; ++i)
+			h[i] = (T[kd + i] >> s) |
+			       (T[kd + i + 1] << (MP_DIGIT_BITS - s));
+
+		h[i] = T[kd + i] >> s;
+		T[kd] &= ((digit_t) 1 << s) - 1;
+		i = kd + 1;
+	}
+	else {
+		for (i = 0; i < hl; ++i)
+			h[i] = T[kd + i];
+
+		i = kd;
+	}
+
+	for (; i < tl; ++i)
+		T[i] = 0;
+
+	for (carry = 0, i = 0; i < hl; ++i) {
+		mp_digit_fma (&hi, &lo, h[i], c, T[i]);
+		hi += mp_digit_add (&T[i], lo, carry);
+		carry = hi;
+	}
+
+	for (; i < tl; ++i)
+		carry = mp_digit_add (&T[i], T[i], carry);
+}
+
+/*
+ * Stores (T, len) mod M into (r, len) using (S, len) as a temporary.
+ * Constraint: T < 2M.
+ */
+static void mp_solinas_final (const struct mp_solinas *o, digit_t *r,
+			      const digit_t *T, digit_t *S)
+{
+	const size_t len = o->len;
+	digit_t mask = 0 - (digit_t) mp_sub_n (S, T, o->m, len, 0);
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+		r[i] = (T[i] & mask) | (S[i] & ~mask);
+}
+
+/*
+ * Adds y to (T, len) and returns carry.
+ */
+static digit_t mp_solinas_add_1 (digit_t *T, size_t len, digit_t y)
+{
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+		y = mp_digit_add (&T[i], T[i], y);
+
+	return y;
+}
+
+/*
+ * If C' = C 2^(len w - k) fits into digit, then X = H B^len + L is folded
+ * at digit boundary into L + H C' twice, and the carry out of the second
+ * fold is small, thus the third one does not overflow: T < B^len. Last
+ * fold at 2^k with H < 2^(len w - k) gives T < 2^k + C' < 2M. Otherwise
+ * three folds at 2^k give X < 2^k + C^2, X < 2^k + C and X < 2^k
+ * respectively.
+ */
+static void mp_solinas_reduce_pm (const struct mp_solinas *o, digit_t *r,
+				  const digit_t *x)
+{
+	const size_t len = o->len, kd = o->bits / MP_DIGIT_BITS;
+	const int s = o->bits % MP_DIGIT_BITS;
+	const int d = (MP_DIGIT_BITS - s) % MP_DIGIT_BITS;
+	const digit_t c = o->c[0];
+	digit_t *T = o->ws + len * 2, *H = T + len * 2 + 1, hi, lo, carry;
+	size_t i;
+
+	if (mp_digit_clz (c) < d) {
+		mp_copy (T, x, len * 2);
+
+		mp_solinas_fold (o, T, len * 2, H);
+		mp_solinas_fold (o, T, kd + 2,  H);
+		mp_solinas_fold (o, T, kd + 1,  H);
+
+		mp_solinas_final (o, r, T, H);
+		return;
+	}
+
+	for (carry = 0, i = 0; i < len; ++i) {
+		mp_digit_fma (&hi, &lo, x[len + i], c << d, x[i]);
+		hi += mp_digit_add (&T[i], lo, carry);
+		carry = hi;
+	}
+
+	mp_digit_fma (&hi, &lo, carry, c << d, T[0]);
+	T[0] = lo;
+	carry = mp_solinas_add_1 (T + 1, len - 1, hi);
+	mp_solinas_add_1 (T, len, carry * (c << d));
+
+	if (s != 0) {
+		hi = T[len - 1] >> s;
+		T[len - 1] &= ((digit_t) 1 << s) - 1;
+		mp_solinas_add_1 (T, len, hi * c);
+	}
+
+	mp_solinas_final (o, r, T, H);
+}
+
+/*
+ * Accumulates every low chunk with high ones multiplied by matrix terms
+ * of its column and propagates carry: Y = sum y[i] 2^(32 i) + t 2^k, then
+ * folds small signed carry t back with terms of C until it vanishes, thus
+ * Y < 2^k < 2M at the end.
+ */
+static void mp_solinas_reduce_gm (const struct mp_solinas *o, digit_t *r,
+				  const digit_t *x)
+{
+	const size_t len = o->len, n = o->bits / MP_CHUNK_BITS;
+	const int *c = o->t, *p = c + n;
+	digit_t *T = o->ws + len * 2, *H = T + len * 2 + 1;
+	int64_t h[n], v, t = 0, f;
+	uint32_t y[n + 1];
+	size_t i, k;
+
+	for (i = 0; i < n; ++i)
+		h[i] = mp_chunk (x, n + i);
+
+	for (i = 0; i < n; ++i) {
+		for (v = mp_chunk (x, i) + t, k = *p++; k > 0; --k, p += 2)
+			v += p[1] * h[p[0]];
+
+		y[i] = v;
+		t = (v - y[i]) / ((int64_t) 1 << MP_CHUNK_BITS);
+	}
+
+	while ((f = t) != 0)
+		for (t = 0, i = 0; i < n; ++i) {
+			v = y[i] + t + f * c[i];
+			y[i] = v;
+			t = (v - y[i]) / ((int64_t) 1 << MP_CHUNK_BITS);
+		}
+
+#if MP_DIGIT_BITS == 64
+	for (y[n] = 0, i = 0; i < len; ++i)
+		T[i] = y[i * 2] | (digit_t) y[i * 2 + 1] << MP_CHUNK_BITS;
+#else
+	for (i = 0; i < len; ++i)
+		T[i] = y[i];
+#endif
+
+	mp_solinas_final (o, r, T, H);
+}
+
+void mp_solinas_reduce (const struct mp_solinas *o, digit_t *r,
+			const digit_t *x)
+{
+	if (o->t == NULL)
+		mp_solinas_reduce_pm (o, r, x);
+	else
+		mp_solinas_reduce_gm (o, r, x);
+}
+
+void mp_solinas_mul (const struct mp_solinas *o, digit_t *r,
+		     const digit_t *x, const digit_t *y)
+{
+	const size_t len = o->len;
+	digit_t *P = o->ws;
+
+	mp_mul_ws (P, x, len, y, len, P + len * 5 + 2);
+	mp_solinas_reduce (o, r, P);
+}
+
+void mp_solinas_sqr (const struct mp_solinas *o, digit_t *r,
+		     const digit_t *x)
+{
+	const size_t len = o->len;
+	digit_t *P = o->ws;
+
+	mp_sqr_ws (P, x, len, P + len * 5 + 2);
+	mp_solinas_reduce (o, r, P);
+}
@@ -92,6 +92,24 @@ static clock_t gauge_mul (size_t len, size_t count)
 	return clock () - t;
 }
 
+/*
+ * Gauge NTT multiplication operation
+ */
+
+static clock_t gauge_mul_ntt (size_t len, size_t count)
+{
+	digit_t a[len], b[len], m[len * 2];
+	clock_t t;
+
+	mp_random (a, len);
+	mp_random (b, len);
+
+	for (t = clock (); count > 0; --count)
+		mp_mul_ntt (m, a, len, b, len);
+
+	return clock () - t;
+}
+
 /*
  * Gauge division operation
  */
@@ -190,6 +208,8 @@ void gauge (size_t len, size_t count, gauge_fn *f,
  */
 
 #define MAX_LEN		100
+#define MIN_BIG_LEN	1000
+#define MAX_BIG_LEN	16000
 
 int main (int argc, char *argv[])
 {
@@ -225,5 +245,15 @@ int main (int argc, char *argv[])
 	for (len = 1; len <= MAX_LEN; ++len)
 		gauge (len, 2000, gauge_div, root, "div");
 
+	printf ("\nTest large a * b\n\n");
+
+	for (len = MIN_BIG_LEN; len <= MAX_BIG_LEN; len += MIN_BIG_LEN)
+		gauge (len, 1, gauge_mul, root, "mul-big");
+
+	printf ("\nTest large NTT a * b\n\n");
+
+	for (len = MIN_BIG_LEN; len <= MAX_BIG_LEN; len += MIN_BIG_LEN)
+		gauge (len, 1, gauge_mul_ntt, root, "mul-ntt-big");
+
 	return 0;
 }
@@ -12,7 +12,20 @@
 #include <time.h>
 
 #include <mp/alloc.h>
+#include <mp/barrett.h>
+#include <mp/conv.h>
 #include <mp/core.h>
+#include <mp/digit.h>
+#include <mp/div.h>
+#include <mp/gcd.h>
+#include <mp/mod.h>
+#include <mp/mont-fixed.h>
+#include <mp/mont-mul.h>
+#include <mp/solinas.h>
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(a)  (sizeof (a) / sizeof ((a)[0]))
+#endif
 
 static void mp_random (digit_t *o, size_t len)
 {
@@ -220,18 +233,118 @@ static int test_mul_fuzzy (size_t len, size_t count)
 	return ok;
 }
 
+/*
+ * Multiplication versus school book multiplication test
+ */
+
+struct test_mul_sb {
+	digit_t *a, *b, *m, *n;
+	size_t alen, blen;
+};
+
+static int test_mul_sb_init (struct test_mul_sb *o, size_t alen, size_t blen)
+{
+	if ((o->a = mp_alloc (alen)) == NULL)		goto no_a;
+	if ((o->b = mp_alloc (blen)) == NULL)		goto no_b;
+	if ((o->m = mp_alloc (alen + blen)) == NULL)	goto no_m;
+	if ((o->n = mp_alloc (alen + blen)) == NULL)	goto no_n;
+
+	o->alen = alen;
+	o->blen = blen;
+	return 1;
+
+no_n:	mp_free (o->m);
+no_m:	mp_free (o->b);
+no_b:	mp_free (o->a);
+no_a:	perror ("test mul-sb");
+	return 0;
+}
+
+static void test_mul_sb_fini (struct test_mul_sb *o)
+{
+	mp_free (o->n);
+	mp_free (o->m);
+	mp_free (o->b);
+	mp_free (o->a);
+}
+
+static void test_mul_sb_mix (struct test_mul_sb *o)
+{
+	mp_random (o->a, o->alen);
+	mp_random (o->b, o->blen);
+}
+
+static int test_mul_sb (struct test_mul_sb *o)
+{
+	digit_t *a = o->a, *b = o->b, *m = o->m, *n = o->n;
+	size_t alen = o->alen, blen = o->blen;
+	int ok;
+
+	/*
+	 * Test for a * b = ntt (a, b) = sb (a, b)
+	 */
+	mp_mul    (m, a, alen, b, blen);
+	mp_mul_sb (n, a, alen, b, blen);
+
+	ok = mp_cmp_n (m, n, alen + blen) == 0;
+
+	if (ok && mp_mul_ntt (m, a, alen, b, blen))
+		ok = mp_cmp_n (m, n, alen + blen) == 0;
+
+	/*
+	 * Test for b^2 = sb (b, b)
+	 */
+	if (ok) {
+		mp_sqr    (m, b, blen);
+		mp_mul_sb (n, b, blen, b, blen);
+
+		ok = mp_cmp_n (m, n, blen * 2) == 0;
+
+		if (ok && mp_mul_ntt (m, b, blen, b, blen))
+			ok = mp_cmp_n (m, n, blen * 2) == 0;
+	}
+
+	if (!ok) {
+		printf ("mul-sb (%zu, %zu) failed:\n", alen, blen);
+
+		mp_show ("\ta  =", a, alen);
+		mp_show ("\tb  =", b, blen);
+		mp_show ("\tab =", m, alen + blen);
+		mp_show ("\tsb =", n, alen + blen);
+	}
+
+	return ok;
+}
+
+static int test_mul_sb_fuzzy (size_t alen, size_t blen, size_t count)
+{
+	struct test_mul_sb o;
+	int ok;
+
+	if (!test_mul_sb_init (&o, alen, blen))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		test_mul_sb_mix (&o);
+		ok &= test_mul_sb (&o);
+	}
+
+	test_mul_sb_fini (&o);
+	return ok;
+}
+
 /*
  * Basic division with multiplication and addition test
  */
 
 struct test_div {
 	digit_t *a, *b, *c, *m, *s, *q, *r;
-	size_t len;
+	size_t alen, len;
 };
 
-static int test_div_init (struct test_div *o, size_t len)
+static int test_div_init (struct test_div *o, size_t alen, size_t len)
 {
-	size_t alen = len + 2, mlen, slen, qlen, rlen;
+	size_t mlen, slen, qlen, rlen;
 
 	if ((o->a  = mp_alloc (alen)) == NULL)	goto no_a;
 	if ((o->b  = mp_alloc (len))  == NULL)	goto no_b;
@@ -247,7 +360,8 @@ static int test_div_init (struct test_div *o, size_t len)
 	if ((o->q = mp_alloc (qlen)) == NULL)	goto no_q;
 	if ((o->r = mp_alloc (rlen)) == NULL)	goto no_r;
 
-	o->len = len;
+	o->alen = alen;
+	o->len  = len;
 	return 1;
 
 no_r:	mp_free (o->q);
@@ -274,7 +388,7 @@ static void test_div_fini (struct test_div *o)
 static void test_div_mix (struct test_div *o)
 {
 	digit_t *a = o->a, *b = o->b, *c = o->c;
-	size_t len = o->len, alen = o->len + 2;
+	size_t len = o->len, alen = o->alen;
 
 	mp_random (a, alen);
 	mp_random (b, len);
@@ -292,7 +406,7 @@ static int test_div (struct test_div *o)
 {
 	digit_t *a = o->a, *b = o->b, *c = o->c;
 	digit_t *m = o->m, *s = o->s, *q = o->q, *r = o->r;
-	size_t len = o->len, alen = len + 2, clen, mlen, slen, qlen, rlen;
+	size_t len = o->len, alen = o->alen, clen, mlen, slen, qlen, rlen;
 	int ok;
 
 	mlen = alen + len;
@@ -303,7 +417,11 @@ static int test_div (struct test_div *o)
 	/*
 	 * Test for (ab + c) / b = (a, c), where c < b
 	 */
-	mp_mul (m, a, alen, b, len);
+	if (alen >= len)
+		mp_mul (m, a, alen, b, len);
+	else
+		mp_mul (m, b, len, a, alen);
+
 	s[slen - 1] = mp_add (s, m, mlen, c, len, 0);
 
 	rlen = mp_div (q, r, s, slen, b, len);
@@ -330,15 +448,29 @@ static int test_div (struct test_div *o)
 		mp_show ("\tr      =", r, rlen);
 	}
 
+	/*
+	 * Test that mp_mod gives the same remainder, in place
+	 */
+	rlen = mp_normalize (s, mp_mod (s, s, slen, b, len));
+
+	if (!(rlen == clen && mp_cmp_n (s, c, clen) == 0)) {
+		printf ("mod (%zu) failed:\n", len);
+
+		mp_show ("\tb      =", b, len);
+		mp_show ("\tc      =", c, len);
+		mp_show ("\tr      =", s, rlen);
+		ok = 0;
+	}
+
 	return ok;
 }
 
-static int test_div_fuzzy (size_t len, size_t count)
+static int test_div_fuzzy (size_t alen, size_t len, size_t count)
 {
 	struct test_div o;
 	int ok;
 
-	if (!test_div_init (&o, len))
+	if (!test_div_init (&o, alen, len))
 		return 0;
 
 	for (ok = 1; count > 0; --count) {
@@ -350,32 +482,999 @@ static int test_div_fuzzy (size_t len, size_t count)
 	return ok;
 }
 
+/*
+ * Single digit division with precomputed inverse test
+ */
+
+struct test_div_1 {
+	digit_t *a, *q, *p;
+	size_t len;
+};
+
+static int test_div_1_init (struct test_div_1 *o, size_t len)
+{
+	if ((o->a = mp_alloc (len)) == NULL)	goto no_a;
+	if ((o->q = mp_alloc (len)) == NULL)	goto no_q;
+	if ((o->p = mp_alloc (len)) == NULL)	goto no_p;
+
+	o->len = len;
+	return 1;
+
+no_p:	mp_free (o->q);
+no_q:	mp_free (o->a);
+no_a:	perror ("test div_1");
+	return 0;
+}
+
+static void test_div_1_fini (struct test_div_1 *o)
+{
+	mp_free (o->p);
+	mp_free (o->q);
+	mp_free (o->a);
+}
+
+static int test_div_1 (struct test_div_1 *o, digit_t y)
+{
+	digit_t *a = o->a, *q = o->q, *p = o->p;
+	size_t len = o->len;
+	digit_t v = mp_div_1_inv (y), r, s, t, c[MP_MOD_1S_SIZE];
+	int ok;
+
+	r = mp_div_1    (q, a, len, y);
+	s = mp_div_1_pi (p, a, len, y, v);
+	t = mp_mod_1_pi (a, len, y, v);
+
+	ok = r == s && r == t && mp_cmp_n (q, p, len) == 0;
+
+	if (y <= MP_DIGIT_ROOF / 4) {
+		mp_mod_1s_init (c, y);
+		t = mp_mod_1s (a, len, y, c);
+		ok &= r == t;
+	}
+
+	if (!ok) {
+		printf ("div_1 (%zu) failed:\n", len);
+
+		mp_show ("\ta  =", a, len);
+		mp_show ("\ty  =", &y, 1);
+		mp_show ("\tq  =", q, len);
+		mp_show ("\tq' =", p, len);
+		mp_show ("\tr  =", &r, 1);
+		mp_show ("\tr' =", &s, 1);
+		mp_show ("\tr\" =", &t, 1);
+	}
+
+	return ok;
+}
+
+#define MOD_1S_COUNT	21
+
+static int test_mod_1s_batch (struct test_div_1 *o)
+{
+	digit_t y[MOD_1S_COUNT], c[MOD_1S_COUNT * MP_MOD_1S_SIZE];
+	digit_t r[MOD_1S_COUNT];
+	size_t i;
+
+	for (i = 0; i < MOD_1S_COUNT; ++i) {
+		mp_random (y + i, 1);
+		y[i] = (y[i] >> (2 + rand () % (MP_DIGIT_BITS - 2))) | 1;
+		mp_mod_1s_init (c + i * MP_MOD_1S_SIZE, y[i]);
+	}
+
+	mp_mod_1s_batch (r, o->a, o->len, y, c, MOD_1S_COUNT);
+
+	for (i = 0; i < MOD_1S_COUNT; ++i)
+		if (r[i] != mp_mod_1 (o->a, o->len, y[i])) {
+			printf ("mod_1s_batch (%zu) failed:\n", o->len);
+
+			mp_show ("\ta  =", o->a, o->len);
+			mp_show ("\ty  =", y + i, 1);
+			mp_show ("\tr  =", r + i, 1);
+			return 0;
+		}
+
+	return 1;
+}
+
+static int test_div_1_fuzzy (size_t len, size_t count)
+{
+	struct test_div_1 o;
+	digit_t y;
+	int ok;
+
+	if (!test_div_1_init (&o, len))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		mp_random (o.a, len);
+		mp_random (&y, 1);
+
+		y >>= rand () % MP_DIGIT_BITS;
+		y |= 1 << (rand () % 2);
+
+		ok &= test_div_1 (&o, y);
+	}
+
+	test_div_1_fini (&o);
+	return ok;
+}
+
+static int test_mod_1s_fuzzy (size_t len, size_t count)
+{
+	struct test_div_1 o;
+	int ok;
+
+	if (!test_div_1_init (&o, len))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		mp_random (o.a, len);
+		ok &= test_mod_1s_batch (&o);
+	}
+
+	test_div_1_fini (&o);
+	return ok;
+}
+
+/*
+ * Exact division test: (ab) / b = a
+ */
+
+struct test_divexact {
+	digit_t *a, *b, *m, *q;
+	size_t alen, len;
+};
+
+static int test_divexact_init (struct test_divexact *o, size_t alen,
+			       size_t len)
+{
+	if ((o->a = mp_alloc (alen))       == NULL)	goto no_a;
+	if ((o->b = mp_alloc (len))        == NULL)	goto no_b;
+	if ((o->m = mp_alloc (alen + len)) == NULL)	goto no_m;
+	if ((o->q = mp_alloc (alen + 1))   == NULL)	goto no_q;
+
+	o->alen = alen;
+	o->len  = len;
+	return 1;
+
+no_q:	mp_free (o->m);
+no_m:	mp_free (o->b);
+no_b:	mp_free (o->a);
+no_a:	perror ("test divexact");
+	return 0;
+}
+
+static void test_divexact_fini (struct test_divexact *o)
+{
+	mp_free (o->q);
+	mp_free (o->m);
+	mp_free (o->b);
+	mp_free (o->a);
+}
+
+static void test_divexact_mix (struct test_divexact *o)
+{
+	digit_t *b = o->b;
+	size_t len = o->len;
+
+	mp_random (o->a, o->alen);
+	mp_random (b, len);
+
+	/* b must be odd (if not single digit) and normalized */
+	b[0] |= len > 1 ? 1 : 0;
+	b[0] >>= len > 1 ? 0 : rand () % MP_DIGIT_BITS;
+	b[len - 1] |= (digit_t) 1 << (rand () % MP_DIGIT_BITS);
+}
+
+static int test_divexact (struct test_divexact *o)
+{
+	digit_t *a = o->a, *b = o->b, *m = o->m, *q = o->q;
+	size_t len = o->len, alen = o->alen, mlen = alen + len;
+	digit_t c = 0;
+	int ok;
+
+	if (len == 1) {
+		m[alen] = mp_mul_1 (m, a, alen, b[0]);
+		c = mp_divexact_1 (q, m, mlen, b[0]);
+	}
+	else if (alen >= len) {
+		mp_mul (m, a, alen, b, len);
+		mp_divexact (q, m, mlen, b, len);
+	}
+	else {
+		mp_mul (m, b, len, a, alen);
+		mp_divexact (q, m, mlen, b, len);
+	}
+
+	ok = c == 0 && q[alen] == 0 && mp_cmp_n (q, a, alen) == 0;
+
+	if (!ok) {
+		printf ("divexact (%zu, %zu) failed:\n", alen, len);
+
+		mp_show ("\ta  =", a, alen);
+		mp_show ("\tb  =", b, len);
+		mp_show ("\tab =", m, mlen);
+		mp_show ("\tq  =", q, alen + 1);
+	}
+
+	return ok;
+}
+
+static int test_divexact_fuzzy (size_t alen, size_t len, size_t count)
+{
+	struct test_divexact o;
+	int ok;
+
+	if (!test_divexact_init (&o, alen, len))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		test_divexact_mix (&o);
+		ok &= test_divexact (&o);
+	}
+
+	test_divexact_fini (&o);
+	return ok;
+}
+
+/*
+ * Barrett reduction test against division
+ */
+
+struct test_barrett {
+	digit_t *m, *d, *x, *s, *r;
+	size_t len;
+};
+
+static int test_barrett_init (struct test_barrett *o, size_t len)
+{
+	if ((o->m = mp_alloc (len))         == NULL)	goto no_m;
+	if ((o->d = mp_alloc (len))         == NULL)	goto no_d;
+	if ((o->x = mp_alloc (len * 2))     == NULL)	goto no_x;
+	if ((o->s = mp_alloc (len * 2 + 1)) == NULL)	goto no_s;
+	if ((o->r = mp_alloc (len))         == NULL)	goto no_r;
+
+	o->len = len;
+	return 1;
+
+no_r:	mp_free (o->s);
+no_s:	mp_free (o->x);
+no_x:	mp_free (o->d);
+no_d:	mp_free (o->m);
+no_m:	perror ("test barrett");
+	return 0;
+}
+
+static void test_barrett_fini (struct test_barrett *o)
+{
+	mp_free (o->r);
+	mp_free (o->s);
+	mp_free (o->x);
+	mp_free (o->d);
+	mp_free (o->m);
+}
+
+static void test_barrett_mix (struct test_barrett *o)
+{
+	digit_t *m = o->m, *x = o->x;
+	size_t len = o->len;
+
+	mp_random (m, len);
+	mp_random (x, len * 2);
+
+	/* any modulus with non-zero high digit, X < M B^len */
+	m[len - 1] >>= rand () % MP_DIGIT_BITS;
+	m[len - 1] |= 1;
+	x[len * 2 - 1] %= m[len - 1];
+}
+
+static int test_barrett (struct test_barrett *o)
+{
+	digit_t *m = o->m, *d = o->d, *x = o->x, *s = o->s, *r = o->r;
+	size_t len = o->len;
+	struct mp_barrett b;
+	int shift = mp_digit_clz (m[len - 1]), ok;
+
+	if (!mp_barrett_init (&b, m, len)) {
+		perror ("test barrett");
+		return 0;
+	}
+
+	mp_barrett_reduce (&b, r, x);
+	mp_barrett_fini (&b);
+
+	/* reference: shift to normalize divisor, divide, shift back */
+	mp_copy (d, m, len);
+	mp_copy (s, x, len * 2);
+	s[len * 2] = 0;
+
+	if (shift != 0) {
+		mp_lshift (d, m, len, 0, shift);
+		s[len * 2] = mp_lshift (s, x, len * 2, 0, shift);
+	}
+
+	mp_mod (s, s, len * 2 + 1, d, len);
+
+	if (shift != 0)
+		mp_rshift (s, s, len, 0, shift);
+
+	ok = mp_cmp_n (r, s, len) == 0;
+
+	if (!ok) {
+		printf ("barrett (%zu) failed:\n", len);
+
+		mp_show ("\tm =", m, len);
+		mp_show ("\tx =", x, len * 2);
+		mp_show ("\tr =", r, len);
+		mp_show ("\ts =", s, len);
+	}
+
+	return ok;
+}
+
+static int test_barrett_fuzzy (size_t len, size_t count)
+{
+	struct test_barrett o;
+	int ok;
+
+	if (!test_barrett_init (&o, len))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		test_barrett_mix (&o);
+		ok &= test_barrett (&o);
+	}
+
+	test_barrett_fini (&o);
+	return ok;
+}
+
+/*
+ * Montgomery multiplication test: R B^len = X Y mod M, and squaring gives
+ * the same result as multiplication; masked modular addition and
+ * subtraction give the same results as branching ones
+ */
+
+struct test_mont {
+	digit_t *m, *d, *x, *y, *r, *s, *p, *q;
+	size_t len;
+};
+
+static int test_mont_init (struct test_mont *o, size_t len)
+{
+	if ((o->m = mp_alloc (len))         == NULL)	goto no_m;
+	if ((o->d = mp_alloc (len))         == NULL)	goto no_d;
+	if ((o->x = mp_alloc (len))         == NULL)	goto no_x;
+	if ((o->y = mp_alloc (len))         == NULL)	goto no_y;
+	if ((o->r = mp_alloc (len))         == NULL)	goto no_r;
+	if ((o->s = mp_alloc (len))         == NULL)	goto no_s;
+	if ((o->p = mp_alloc (len * 2 + 1)) == NULL)	goto no_p;
+	if ((o->q = mp_alloc (len * 2 + 1)) == NULL)	goto no_q;
+
+	o->len = len;
+	return 1;
+
+no_q:	mp_free (o->p);
+no_p:	mp_free (o->s);
+no_s:	mp_free (o->r);
+no_r:	mp_free (o->y);
+no_y:	mp_free (o->x);
+no_x:	mp_free (o->d);
+no_d:	mp_free (o->m);
+no_m:	perror ("test mont");
+	return 0;
+}
+
+static void test_mont_fini (struct test_mont *o)
+{
+	mp_free (o->q);
+	mp_free (o->p);
+	mp_free (o->s);
+	mp_free (o->r);
+	mp_free (o->y);
+	mp_free (o->x);
+	mp_free (o->d);
+	mp_free (o->m);
+}
+
+static void test_mont_mix (struct test_mont *o)
+{
+	digit_t *m = o->m, *x = o->x, *y = o->y;
+	size_t len = o->len;
+
+	mp_random (m, len);
+	mp_random (x, len);
+	mp_random (y, len);
+
+	/* odd modulus with non-zero high digit, X < M, Y < M */
+	m[0] |= 1;
+	m[len - 1] >>= rand () % MP_DIGIT_BITS;
+	m[len - 1] |= 1;
+	x[len - 1] %= m[len - 1];
+	y[len - 1] %= m[len - 1];
+}
+
+/*
+ * Reduces (p, 2 len) modulo M into (p, len) with normalized divisor D.
+ */
+static void test_mont_reduce (struct test_mont *o, digit_t *p)
+{
+	const size_t len = o->len;
+	int shift = mp_digit_clz (o->m[len - 1]);
+
+	p[len * 2] = 0;
+
+	if (shift != 0)
+		p[len * 2] = mp_lshift (p, p, len * 2, 0, shift);
+
+	mp_mod (p, p, len * 2 + 1, o->d, len);
+
+	if (shift != 0)
+		mp_rshift (p, p, len, 0, shift);
+}
+
+static int test_mont (struct test_mont *o)
+{
+	digit_t *m = o->m, *d = o->d, *x = o->x, *y = o->y, *r = o->r;
+	digit_t *s = o->s, *p = o->p, *q = o->q;
+	size_t len = o->len;
+	int shift = mp_digit_clz (m[len - 1]), ok;
+	digit_t mu = mp_mont_mu (m[0]);
+
+	mp_mont_mul_n (r, x, y, m, len, mu);
+	mp_mont_sqr_n (s, y, m, len, mu);
+
+	mp_copy (d, m, len);
+
+	if (shift != 0)
+		mp_lshift (d, m, len, 0, shift);
+
+	mp_mul (p, x, len, y, len);
+	mp_zero (q, len);
+	mp_copy (q + len, r, len);
+
+	test_mont_reduce (o, p);
+	test_mont_reduce (o, q);
+
+	ok = mp_cmp_n (r, m, len) < 0 && mp_cmp_n (p, q, len) == 0;
+
+	mp_mont_mul_n (r, y, y, m, len, mu);
+	ok &= mp_cmp_n (r, s, len) == 0;
+
+	mp_mod_add_n     (r, x, y, m, len);
+	mp_mod_add_n_sec (s, x, y, m, len);
+	ok &= mp_cmp_n (r, m, len) < 0 && mp_cmp_n (r, s, len) == 0;
+
+	mp_mod_sub_n     (r, x, y, m, len);
+	mp_mod_sub_n_sec (s, x, y, m, len);
+	ok &= mp_cmp_n (r, m, len) < 0 && mp_cmp_n (r, s, len) == 0;
+
+	if (!ok) {
+		printf ("mont (%zu) failed:\n", len);
+
+		mp_show ("\tm =", m, len);
+		mp_show ("\tx =", x, len);
+		mp_show ("\ty =", y, len);
+		mp_show ("\tp =", p, len);
+		mp_show ("\tq =", q, len);
+		mp_show ("\ts =", s, len);
+	}
+
+	return ok;
+}
+
+static int test_mont_fuzzy (size_t len, size_t count)
+{
+	struct test_mont o;
+	int ok;
+
+	if (!test_mont_init (&o, len))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		test_mont_mix (&o);
+		ok &= test_mont (&o);
+	}
+
+	test_mont_fini (&o);
+	return ok;
+}
+
+/*
+ * Special form reduction test against division for pseudo-Mersenne and
+ * Solinas moduli, uses Montgomery test buffers
+ */
+
+static const char *const solinas_sample[] = {
+	"7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed",
+	"3fffffffffffffffffffffffffffffffb",
+	"fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f",
+	"1fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+	"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+	"fff",
+	"ffffffffffffffffffffffffffffffff000000000000000000000001",
+	"ffffffff00000001000000000000000000000000ffffffffffffffffffffffff",
+	"fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+	"ffffffff0000000000000000ffffffff",
+};
+
+static int test_solinas (struct test_mont *o, const struct mp_solinas *c)
+{
+	digit_t *m = o->m, *x = o->x, *y = o->y, *r = o->r, *s = o->s;
+	digit_t *p = o->p, *q = o->q;
+	size_t len = o->len;
+	int ok;
+
+	mp_random (x, len);
+	mp_random (y, len);
+	x[len - 1] %= m[len - 1];
+	y[len - 1] %= m[len - 1];
+
+	mp_solinas_mul (c, r, x, y);
+	mp_solinas_sqr (c, s, x);
+
+	mp_mul (p, x, len, y, len);
+	mp_mul (q, x, len, x, len);
+
+	test_mont_reduce (o, p);
+	test_mont_reduce (o, q);
+
+	ok = mp_cmp_n (r, p, len) == 0 && mp_cmp_n (s, q, len) == 0;
+
+	if (!ok) {
+		printf ("solinas (%zu) failed:\n", len);
+
+		mp_show ("\tm =", m, len);
+		mp_show ("\tx =", x, len);
+		mp_show ("\ty =", y, len);
+		mp_show ("\tr =", r, len);
+		mp_show ("\tp =", p, len);
+		mp_show ("\ts =", s, len);
+		mp_show ("\tq =", q, len);
+	}
+
+	return ok;
+}
+
+static int test_solinas_fuzzy (const char *M, size_t count)
+{
+	digit_t m[MP_MONT_DIGITS (521)];
+	size_t len = mp_load_hex (m, ARRAY_SIZE (m), M);
+	int shift = mp_digit_clz (m[len - 1]), ok;
+	struct test_mont o;
+	struct mp_solinas c;
+
+	if (!test_mont_init (&o, len))
+		return 0;
+
+	if (!mp_solinas_init (&c, m, len)) {
+		printf ("solinas (%zu) rejected modulus %s\n", len, M);
+		test_mont_fini (&o);
+		return 0;
+	}
+
+	mp_copy (o.m, m, len);
+	mp_copy (o.d, m, len);
+
+	if (shift != 0)
+		mp_lshift (o.d, m, len, 0, shift);
+
+	for (ok = 1; count > 0; --count)
+		ok &= test_solinas (&o, &c);
+
+	mp_solinas_fini (&c);
+	test_mont_fini (&o);
+	return ok;
+}
+
+/*
+ * GCD test: G = gcd (ac, bc) divides both operands, c divides G, and
+ * S ac = G mod bc
+ */
+
+struct test_gcd {
+	digit_t *x, *y, *g, *h, *s, *p, *r, *d;
+	size_t xlen, ylen;
+};
+
+static int test_gcd_init (struct test_gcd *o, size_t alen, size_t blen)
+{
+	const size_t xlen = alen + 1, ylen = blen + 1, n = xlen + ylen + 1;
+
+	if ((o->x = mp_alloc (xlen)) == NULL)	goto no_x;
+	if ((o->y = mp_alloc (ylen)) == NULL)	goto no_y;
+	if ((o->g = mp_alloc (n))    == NULL)	goto no_g;
+	if ((o->h = mp_alloc (n))    == NULL)	goto no_h;
+	if ((o->s = mp_alloc (ylen)) == NULL)	goto no_s;
+	if ((o->p = mp_alloc (n))    == NULL)	goto no_p;
+	if ((o->r = mp_alloc (n))    == NULL)	goto no_r;
+	if ((o->d = mp_alloc (n))    == NULL)	goto no_d;
+
+	o->xlen = xlen;
+	o->ylen = ylen;
+	return 1;
+
+no_d:	mp_free (o->r);
+no_r:	mp_free (o->p);
+no_p:	mp_free (o->s);
+no_s:	mp_free (o->h);
+no_h:	mp_free (o->g);
+no_g:	mp_free (o->y);
+no_y:	mp_free (o->x);
+no_x:	perror ("test gcd");
+	return 0;
+}
+
+static void test_gcd_fini (struct test_gcd *o)
+{
+	mp_free (o->d);
+	mp_free (o->r);
+	mp_free (o->p);
+	mp_free (o->s);
+	mp_free (o->h);
+	mp_free (o->g);
+	mp_free (o->y);
+	mp_free (o->x);
+}
+
+static void test_gcd_mix (struct test_gcd *o)
+{
+	const size_t alen = o->xlen - 1, blen = o->ylen - 1;
+	digit_t c;
+
+	mp_random (o->x, alen);
+	mp_random (o->y, blen);
+	mp_random (&c, 1);
+
+	c >>= rand () % MP_DIGIT_BITS;
+	c |= 1;
+
+	if (alen > 1 && rand () % 4 == 0)
+		o->x[rand () % alen] = 0;  /* sparse */
+
+	o->x[alen] = mp_mul_1 (o->x, o->x, alen, c);
+	o->y[blen] = mp_mul_1 (o->y, o->y, blen, c);
+}
+
+/* check that (d, dlen) divides (n, nlen) using (r, nlen + 1) */
+static int test_gcd_divides (struct test_gcd *o, const digit_t *d, size_t dlen,
+			     const digit_t *n, size_t nlen)
+{
+	digit_t *r = o->r, *e = o->d;
+	int k;
+
+	if ((nlen = mp_normalize (n, nlen)) < dlen)
+		return nlen == 0;
+
+	if ((k = mp_digit_clz (d[dlen - 1])) > 0) {
+		r[nlen] = mp_lshift (r, n, nlen, 0, k);
+		mp_lshift (e, d, dlen, 0, k);
+	}
+	else {
+		mp_copy (r, n, nlen);
+		mp_copy (e, d, dlen);
+		r[nlen] = 0;
+	}
+
+	mp_mod (r, r, nlen + 1, e, dlen);
+	return mp_normalize (r, dlen) == 0;
+}
+
+static int test_gcd (struct test_gcd *o)
+{
+	digit_t *x = o->x, *y = o->y, *g = o->g, *h = o->h, *s = o->s;
+	digit_t *p = o->p;
+	size_t xlen = o->xlen, ylen = o->ylen, glen, hlen, slen, plen;
+	int ok;
+
+	glen = mp_gcd    (g, x, xlen, y, ylen);
+	hlen = mp_gcdext (h, s, x, xlen, y, ylen);
+	slen = mp_normalize (s, ylen);
+
+	ok = glen > 0 && glen == hlen && mp_cmp_n (g, h, glen) == 0 &&
+	     test_gcd_divides (o, g, glen, x, xlen) &&
+	     test_gcd_divides (o, g, glen, y, ylen) &&
+	     slen > 0 && mp_cmp_n (s, y, ylen) <= 0;
+
+	if (ok) {
+		plen = xlen + slen;
+
+		if (xlen >= slen)
+			mp_mul (p, x, xlen, s, slen);
+		else
+			mp_mul (p, s, slen, x, xlen);
+
+		mp_sub (p, p, plen, g, glen, 0);
+		ok = test_gcd_divides (o, y, mp_normalize (y, ylen), p, plen);
+	}
+
+	if (!ok) {
+		printf ("gcd (%zu, %zu) failed:\n", xlen, ylen);
+
+		mp_show ("\tx  =", x, xlen);
+		mp_show ("\ty  =", y, ylen);
+		mp_show ("\tg  =", g, glen);
+		mp_show ("\tg' =", h, hlen);
+		mp_show ("\ts  =", s, ylen);
+	}
+
+	return ok;
+}
+
+static int test_gcd_fuzzy (size_t alen, size_t blen, size_t count)
+{
+	struct test_gcd o;
+	int ok;
+
+	if (!test_gcd_init (&o, alen, blen))
+		return 0;
+
+	for (ok = 1; count > 0; --count) {
+		test_gcd_mix (&o);
+		ok &= test_gcd (&o);
+	}
+
+	test_gcd_fini (&o);
+	return ok;
+}
+
+/*
+ * Arena allocator test
+ */
+
+#define ARENA_SLOTS  64
+
+static void test_arena_fill (digit_t *p, size_t len, size_t tag)
+{
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+		p[i] = tag * 1000 + i;
+}
+
+static int test_arena_check (const digit_t *p, size_t len, size_t tag)
+{
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+		if (p[i] != tag * 1000 + i)
+			return 0;
+
+	return 1;
+}
+
+/*
+ * Size classes: released block is reused for the next request of the
+ * same class, realloc within the class keeps the block, realloc beyond
+ * it moves the contents.
+ */
+static int test_arena_classes (void)
+{
+	digit_t *p, *q;
+	int ok;
+
+	p = mp_alloc (10);
+	mp_free (p);
+	ok = (q = mp_alloc (12)) == p;
+
+	test_arena_fill (q, 12, 1);
+	ok &= (p = mp_realloc (q, 13)) == q && test_arena_check (p, 12, 1);
+	ok &= (q = mp_realloc (p, 500)) != p && test_arena_check (q, 12, 1);
+	ok &= mp_alloc (11) == p;  /* the old block is in the pool again */
+
+	mp_free (q);
+	ok &= mp_alloc (400) == q;
+
+	/* dedicated chunk for huge block */
+	ok &= (p = mp_alloc (MP_ARENA_CLASSES << 12)) != NULL;
+	test_arena_fill (p, MP_ARENA_CLASSES << 12, 2);
+	ok &= test_arena_check (p, MP_ARENA_CLASSES << 12, 2);
+
+	if (!ok)
+		printf ("arena size classes test failed\n");
+
+	return ok;
+}
+
+/*
+ * Random sequence of alloc, realloc and free, contents of every live block
+ * is checked against its tag.
+ */
+static int test_arena_mix (size_t count)
+{
+	digit_t *p[ARENA_SLOTS] = { NULL }, *q;
+	size_t len[ARENA_SLOTS], tag[ARENA_SLOTS], i, n, t = 0;
+	int ok = 1;
+
+	for (; count > 0; --count) {
+		i = rand () % ARENA_SLOTS;
+		n = 1 + rand () % (rand () % 8 == 0 ? 5000 : 50);
+
+		if (p[i] != NULL && !test_arena_check (p[i], len[i], tag[i]))
+			ok = 0;
+
+		switch (p[i] == NULL ? 0 : rand () % 2 + 1) {
+		case 0:
+			if ((p[i] = mp_alloc (n)) == NULL)
+				return 0;
+
+			test_arena_fill (p[i], len[i] = n, tag[i] = ++t);
+			break;
+		case 1:
+			if ((q = mp_realloc (p[i], n)) == NULL)
+				return 0;
+
+			if (n < len[i])
+				len[i] = n;
+
+			if (!test_arena_check (q, len[i], tag[i]))
+				ok = 0;
+
+			test_arena_fill (p[i] = q, len[i] = n, tag[i]);
+			break;
+		default:
+			mp_free (p[i]);
+			p[i] = NULL;
+		}
+	}
+
+	for (i = 0; i < ARENA_SLOTS; ++i)
+		mp_free (p[i]);
+
+	if (!ok)
+		printf ("arena mix test failed\n");
+
+	return ok;
+}
+
+static int test_arena_fuzzy (size_t count)
+{
+	struct mp_arena a;
+	size_t i;
+	int ok;
+
+	mp_arena_init (&a);
+
+	ok =  mp_set_allocator (&a.allocator) == NULL;
+	ok &= test_arena_classes () && test_arena_mix (count);
+	ok &= mp_set_allocator (NULL) == &a.allocator;
+
+	/* default allocator is in use again: the arena is not touched */
+	i = a.avail;
+	mp_free (mp_alloc (8));
+	ok &= a.avail == i;
+
+	mp_arena_fini (&a);
+
+	/* fini releases all chunks and resets the arena */
+	ok &= a.chunk == NULL && a.next == NULL && a.avail == 0;
+
+	for (i = 0; i < MP_ARENA_CLASSES; ++i)
+		ok &= a.pool[i] == NULL;
+
+	if (!ok)
+		printf ("arena test failed\n");
+
+	return ok;
+}
+
 /*
  * Top-level code
  */
 
 #define MAX_LEN		32
+#define MAX_BIG_LEN	400
 
 #define ADD_COUNT	10000
 #define MUL_COUNT	10000
+#define MUL_BIG_COUNT	8
 #define DIV_COUNT	10000
+#define DIV_BIG_COUNT	8
+#define ARENA_COUNT	100000
 
-int main (int argc, char *argv[])
+/*
+ * Operands from MP_GCD_DC_CUTOFF digits go through half-GCD. The default
+ * cutoff is large, thus only a few samples are affordable in the default
+ * run: make check-gcd rebuilds the tests with lowered cutoffs and many
+ * samples to cover mp_gcd_reduce and half-GCD recursion.
+ */
+#ifndef GCD_BIG_COUNT
+#define GCD_BIG_COUNT	1
+#endif
+
+static int test_gcd_all (void)
 {
 	size_t len;
+	int ok = 1;
+
+	for (len = 1; len <= MAX_LEN; ++len) {
+		ok &= test_gcd_fuzzy (len, len, DIV_COUNT / 100);
+		ok &= test_gcd_fuzzy (len * 3, len, DIV_COUNT / 100);
+		ok &= test_gcd_fuzzy (len, len * 2 + 1, DIV_COUNT / 100);
+	}
+
+	for (len = MP_GCD_DC_CUTOFF; len <= MP_GCD_DC_CUTOFF * 2;
+	     len += len / 2) {
+		ok &= test_gcd_fuzzy (len, len, GCD_BIG_COUNT);
+		ok &= test_gcd_fuzzy (len, len - len / 3, GCD_BIG_COUNT);
+		ok &= test_gcd_fuzzy (len * 2, len, GCD_BIG_COUNT);
+	}
+
+	return ok;
+}
+
+int main (int argc, char *argv[])
+{
+	size_t len, i;
 	time_t start = time (NULL);
+	struct mp_arena arena;
 	int ok = 1;
 
 	srand ((unsigned) start);
 
+	if (argc > 1 && strcmp (argv[1], "gcd") == 0)
+		return test_gcd_all () ? 0 : 1;
+
 	for (len = 0; len <= MAX_LEN; ++len)
 		ok &= test_add_fuzzy (len, ADD_COUNT);
 
 	for (len = 0; len <= MAX_LEN; ++len)
 		ok &= test_mul_fuzzy (len, MUL_COUNT);
 
+	for (len = 1; len < MAX_LEN; ++len)
+		ok &= test_mul_sb_fuzzy (len, len, MUL_BIG_COUNT);
+
+	for (len = MAX_LEN; len <= MAX_BIG_LEN; len += 7) {
+		ok &= test_mul_sb_fuzzy (len, len, MUL_BIG_COUNT);
+		ok &= test_mul_sb_fuzzy (len, len - len / 4, MUL_BIG_COUNT);
+		ok &= test_mul_sb_fuzzy (len * 2, len, MUL_BIG_COUNT);
+	}
+
+	mp_arena_init (&arena);
+	mp_set_allocator (&arena.allocator);
+
+	for (len = MAX_LEN; len <= MAX_BIG_LEN; len += 41)
+		ok &= test_mul_sb_fuzzy (len * 2, len, MUL_BIG_COUNT);
+
+	mp_set_allocator (NULL);
+	mp_arena_fini (&arena);
+
+	ok &= test_arena_fuzzy (ARENA_COUNT);
+
+	for (len = 1; len <= MAX_LEN; ++len) {
+		ok &= test_div_1_fuzzy (len, DIV_COUNT);
+		ok &= test_mod_1s_fuzzy (len, DIV_COUNT / 100);
+	}
+
 	for (len = 1; len <= MAX_LEN; ++len)
-		ok &= test_div_fuzzy (len, DIV_COUNT);
+		ok &= test_div_fuzzy (len + 2, len, DIV_COUNT);
+
+	for (len = MAX_LEN; len <= MAX_BIG_LEN; len += 7) {
+		ok &= test_div_fuzzy (len + 2, len, DIV_BIG_COUNT);
+		ok &= test_div_fuzzy (len - 2, len, DIV_BIG_COUNT);
+		ok &= test_div_fuzzy (len * 3 + 5, len, DIV_BIG_COUNT);
+	}
+
+	for (len = 1; len <= MAX_LEN; ++len) {
+		ok &= test_divexact_fuzzy (len, 1, DIV_COUNT / 10);
+		ok &= test_divexact_fuzzy (len, len, DIV_COUNT / 10);
+		ok &= test_divexact_fuzzy (len * 2, len, DIV_COUNT / 10);
+		ok &= test_divexact_fuzzy (len, len * 2, DIV_COUNT / 10);
+	}
+
+	for (len = 1; len <= MAX_BIG_LEN; len += len < MAX_LEN ? 1 : 7)
+		ok &= test_barrett_fuzzy (len, DIV_BIG_COUNT);
+
+	for (len = 1; len <= MAX_LEN; ++len)
+		ok &= test_mont_fuzzy (len, DIV_COUNT / 10);
+
+	ok &= test_mont_fuzzy (MP_MONT_DIGITS (521),  DIV_COUNT);
+	ok &= test_mont_fuzzy (MP_MONT_DIGITS (4096), DIV_COUNT / 10);
+
+	for (i = 0; i < ARRAY_SIZE (solinas_sample); ++i)
+		ok &= test_solinas_fuzzy (solinas_sample[i], DIV_COUNT);
+
+	ok &= test_gcd_all ();
 
 	return ok ? 0 : 1;
 }